@@ -0,0 +1,319 @@
+// Host-side benchmark and golden-frame regression for the LED pattern kernels in src/LedPatterns.cpp.
+//
+//   led_bench                                    Time every kernel
+//   led_bench --record FILE                      Capture golden frames to FILE
+//   led_bench --compare FILE [--tolerance N]     Check the kernels still render FILE's frames
+//   led_bench --calibrate LOG                    Estimate AVR cycles from a dock's 'B' benchmark output
+//   led_bench --avr-ratio R                      Estimate AVR cycles as R per host ns
+//
+// Every case runs from a fake clock and seeded generators, so its frames are the same on every run.
+// Golden files are "LEDG", a version byte and a case count byte, then for each case its pattern id,
+// energy, pixel count (uint16 LE), frame count (uint16 LE) and the frames as raw RGB.
+
+#include <chrono>
+#include <vector>
+#include <Arduino.h>    // After the standard headers: its min/max macros break <chrono>
+#include <FastLED.h>
+#include "LedPatterns.h"
+#include "TraitPalette.h"
+
+#define GOLDEN_MAGIC "LEDG"
+#define GOLDEN_VERSION 1
+#define FRAME_MS 16                // ~60fps, as the dock's frame scheduler runs
+#define CAPTURE_FRAMES 400
+#define CAPTURE_EVERY 20           // Keep every 20th frame, 20 per case
+#define TIMING_FRAMES 2000
+#define CALIBRATION_PIXELS 24      // The dock benchmarks on its ring (NEOPIXEL_COUNT)
+#define CALIBRATION_ENERGY 42      // ...with ALCHEMIZATION_ENERGY
+#define DEFAULT_AVR_RATIO 40.0     // AVR cycles per host ns; rough, --calibrate replaces it
+#define TRAIT 1                    // RUMINATE, orange
+
+struct BenchCase {
+    LEDPatternId id;
+    uint8_t energy;
+    uint16_t count;
+};
+
+// Ring patterns at the ring's size, the Distiller's at its strip and the Jungle's at its two strips
+static const BenchCase CASES[] = {
+    { LED_PATTERN_NO_ORB, 20, 24 },
+    { LED_PATTERN_ORB_CONNECTED, 20, 24 },
+    { LED_PATTERN_ORB_CONNECTED, 0, 24 },
+    { LED_PATTERN_FLASH, 20, 24 },
+    { LED_PATTERN_ERROR, 20, 24 },
+    { LED_PATTERN_NO_ENERGY, 0, 24 },
+    { LED_PATTERN_IDLE, 20, 24 },
+    { LED_PATTERN_PRIDE, 20, 160 },
+    { LED_PATTERN_FLAME, 20, 160 },
+    { LED_PATTERN_JUNGLE_AMBIENT, 20, 100 },
+    { LED_PATTERN_JUNGLE_PULSE, 20, 100 }
+};
+#define CASE_COUNT (sizeof(CASES) / sizeof(CASES[0]))
+
+static const char* patternName(LEDPatternId id) {
+    return LED_PATTERNS[id].name;
+}
+
+static void resetGenerators() {
+    randomSeed(1);
+    random16_set_seed(1337);
+}
+
+static CRGBPalette16 traitPalette;
+
+static LedPatternFrame makeFrame(CRGB* leds, const BenchCase& c) {
+    LedPatternFrame frame;
+    frame.leds = leds;
+    frame.count = c.count;
+    frame.lanes = (c.id == LED_PATTERN_JUNGLE_AMBIENT || c.id == LED_PATTERN_JUNGLE_PULSE) ? 2 : 1;
+    loadTraitPalette(traitPalette, TRAIT);
+    frame.palette = &traitPalette;
+    frame.color = traitPalette[TRAIT_PALETTE_CENTER / 16];
+    frame.energy = c.energy;
+    frame.now = 0;
+    frame.steps = 0;
+    return frame;
+}
+
+// Runs a case through the engine at FRAME_MS per frame, keeping every CAPTURE_EVERYth frame
+static std::vector<uint8_t> captureCase(const BenchCase& c) {
+    std::vector<CRGB> leds(c.count, CRGB(CRGB::Black));
+    std::vector<uint8_t> frames;
+    LedPatternEngine engine;
+    LedPatternFrame frame = makeFrame(leds.data(), c);
+
+    resetGenerators();
+    engine.start(c.id);
+    for (int i = 1; i <= CAPTURE_FRAMES; i++) {
+        frame.now = (unsigned long)i * FRAME_MS;
+        setFakeMillis(frame.now);
+        if (engine.render(frame) == LED_FRAME_DONE) {
+            engine.start(c.id);
+        }
+        if (i % CAPTURE_EVERY == 0) {
+            const uint8_t* raw = leds[0].raw;
+            frames.insert(frames.end(), raw, raw + c.count * 3);
+        }
+    }
+    return frames;
+}
+
+// Host ns per frame, rendering a step every frame as the dock's 'B' command does
+static double timeKernel(const BenchCase& c, uint16_t count) {
+    BenchCase sized = c;
+    sized.count = count;
+    std::vector<CRGB> leds(count, CRGB(CRGB::Black));
+    LedPatternFrame frame = makeFrame(leds.data(), sized);
+    LedPatternState state;
+    LEDPatternConfig pattern = LED_PATTERNS[c.id];
+    memset(&state, 0, sizeof(state));
+    frame.steps = 1;
+    resetGenerators();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < TIMING_FRAMES; i++) {
+        frame.now += max(pattern.interval, (uint16_t)1);
+        setFakeMillis(frame.now);
+        pattern.render(frame, state);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / TIMING_FRAMES;
+}
+
+/********************** GOLDEN FILES *****************************/
+
+static void putWord(FILE* file, uint16_t value) {
+    fputc(value & 0xFF, file);
+    fputc(value >> 8, file);
+}
+
+static int getWord(FILE* file) {
+    int low = fgetc(file);
+    int high = fgetc(file);
+    return (low < 0 || high < 0) ? -1 : low | (high << 8);
+}
+
+static int recordGolden(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+    fwrite(GOLDEN_MAGIC, 1, 4, file);
+    fputc(GOLDEN_VERSION, file);
+    fputc(CASE_COUNT, file);
+    for (size_t i = 0; i < CASE_COUNT; i++) {
+        const BenchCase& c = CASES[i];
+        std::vector<uint8_t> frames = captureCase(c);
+        fputc(c.id, file);
+        fputc(c.energy, file);
+        putWord(file, c.count);
+        putWord(file, CAPTURE_FRAMES / CAPTURE_EVERY);
+        fwrite(frames.data(), 1, frames.size(), file);
+        printf("%-16s energy %3d: %d frames of %d pixels\n", patternName(c.id), c.energy,
+               CAPTURE_FRAMES / CAPTURE_EVERY, c.count);
+    }
+    fclose(file);
+    return 0;
+}
+
+// Compares every golden case with a fresh capture; channels may differ by up to tolerance
+static int compareGolden(const char* path, int tolerance) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+    char magic[4];
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, GOLDEN_MAGIC, 4) != 0 || fgetc(file) != GOLDEN_VERSION) {
+        fprintf(stderr, "%s: not a version %d golden file\n", path, GOLDEN_VERSION);
+        fclose(file);
+        return 1;
+    }
+
+    int caseCount = fgetc(file);
+    int failures = 0;
+    for (int n = 0; n < caseCount; n++) {
+        int id = fgetc(file);
+        int energy = fgetc(file);
+        int count = getWord(file);
+        int frameCount = getWord(file);
+        if (id < 0 || id >= LED_PATTERN_COUNT || energy < 0 || count <= 0 || frameCount < 0) {
+            fprintf(stderr, "%s: truncated or corrupt at case %d\n", path, n);
+            fclose(file);
+            return 1;
+        }
+        std::vector<uint8_t> golden((size_t)count * 3 * frameCount);
+        if (fread(golden.data(), 1, golden.size(), file) != golden.size()) {
+            fprintf(stderr, "%s: truncated at case %d\n", path, n);
+            fclose(file);
+            return 1;
+        }
+
+        BenchCase c = { (LEDPatternId)id, (uint8_t)energy, (uint16_t)count };
+        std::vector<uint8_t> frames = captureCase(c);
+        if (frames.size() != golden.size()) {
+            printf("%-16s energy %3d: FAIL, %zu bytes captured, %zu golden\n", patternName(c.id), energy,
+                   frames.size(), golden.size());
+            failures++;
+            continue;
+        }
+
+        int maxDiff = 0;
+        int firstFrame = -1;
+        size_t beyond = 0;
+        for (size_t i = 0; i < frames.size(); i++) {
+            int diff = abs(frames[i] - golden[i]);
+            if (diff > maxDiff) {
+                maxDiff = diff;
+            }
+            if (diff > tolerance) {
+                beyond++;
+                if (firstFrame < 0) {
+                    firstFrame = i / (count * 3);
+                }
+            }
+        }
+        if (firstFrame < 0) {
+            printf("%-16s energy %3d: ok, max diff %d\n", patternName(c.id), energy, maxDiff);
+        } else {
+            printf("%-16s energy %3d: FAIL, max diff %d, first at frame %d, %zu of %zu channels\n",
+                   patternName(c.id), energy, maxDiff, firstFrame, beyond, frames.size());
+            failures++;
+        }
+    }
+    fclose(file);
+
+    printf("%d of %d cases differ beyond tolerance %d\n", failures, caseCount, tolerance);
+    return failures ? 1 : 0;
+}
+
+/********************** TIMING *****************************/
+
+// Reads a dock's 'B' output ("name: N us, C cycles" per kernel) and returns AVR cycles per host ns,
+// timing the same kernels here the same way. Returns 0 if no kernel matched.
+static double calibrate(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return 0;
+    }
+    double avrCycles = 0;
+    double hostNs = 0;
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+        char name[32];
+        unsigned long micros;
+        unsigned long cycles;
+        if (sscanf(line, "%31[^:]: %lu us, %lu cycles", name, &micros, &cycles) != 3) {
+            continue;
+        }
+        for (uint8_t id = 0; id < LED_PATTERN_COUNT; id++) {
+            if (strcmp(name, patternName((LEDPatternId)id)) == 0) {
+                BenchCase c = { (LEDPatternId)id, CALIBRATION_ENERGY, CALIBRATION_PIXELS };
+                avrCycles += cycles;
+                hostNs += timeKernel(c, CALIBRATION_PIXELS);
+            }
+        }
+    }
+    fclose(file);
+    return hostNs > 0 ? avrCycles / hostNs : 0;
+}
+
+static void printTimings(double avrRatio) {
+    printf("%-16s %6s %6s %10s %10s %12s\n", "kernel", "energy", "pixels", "ns/frame", "ns/pixel", "AVR cycles");
+    for (size_t i = 0; i < CASE_COUNT; i++) {
+        const BenchCase& c = CASES[i];
+        double ns = timeKernel(c, c.count);
+        printf("%-16s %6d %6d %10.0f %10.1f %12.0f\n", patternName(c.id), c.energy, c.count, ns,
+               ns / c.count, ns * avrRatio);
+    }
+    printf("AVR cycles estimated at %.1f per host ns\n", avrRatio);
+}
+
+static int usage() {
+    fprintf(stderr, "usage: led_bench [--record FILE | --compare FILE [--tolerance N]]"
+                    " [--calibrate LOG | --avr-ratio R]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    const char* recordPath = NULL;
+    const char* comparePath = NULL;
+    const char* calibrationPath = NULL;
+    int tolerance = 0;
+    double avrRatio = DEFAULT_AVR_RATIO;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--record") == 0 && hasValue) {
+            recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && hasValue) {
+            comparePath = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && hasValue) {
+            tolerance = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--calibrate") == 0 && hasValue) {
+            calibrationPath = argv[++i];
+        } else if (strcmp(argv[i], "--avr-ratio") == 0 && hasValue) {
+            avrRatio = atof(argv[++i]);
+        } else {
+            return usage();
+        }
+    }
+
+    if (recordPath) {
+        return recordGolden(recordPath);
+    }
+    if (comparePath) {
+        return compareGolden(comparePath, tolerance);
+    }
+    if (calibrationPath) {
+        avrRatio = calibrate(calibrationPath);
+        if (avrRatio <= 0) {
+            fprintf(stderr, "%s: no kernel timings found\n", calibrationPath);
+            return 1;
+        }
+    }
+    printTimings(avrRatio);
+    return 0;
+}
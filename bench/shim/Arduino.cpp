@@ -0,0 +1,48 @@
+#include "Arduino.h"
+
+static unsigned long fakeMillis = 0;
+static unsigned long randomState = 1;
+
+void setFakeMillis(unsigned long ms) {
+    fakeMillis = ms;
+}
+
+unsigned long millis() {
+    return fakeMillis;
+}
+
+unsigned long micros() {
+    return fakeMillis * 1000;
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// AVR libc's random(): Park-Miller minimal standard generator
+static long nextRandom() {
+    long x = randomState;
+    if (x == 0) {
+        x = 123459876L;
+    }
+    long hi = x / 127773L;
+    long lo = x % 127773L;
+    x = 16807L * lo - 2836L * hi;
+    if (x < 0) {
+        x += 0x7FFFFFFFL;
+    }
+    randomState = x;
+    return x % 0x80000000UL;
+}
+
+void randomSeed(unsigned long seed) {
+    randomState = seed;
+}
+
+long random(long howBig) {
+    return howBig == 0 ? 0 : nextRandom() % howBig;
+}
+
+long random(long howSmall, long howBig) {
+    return howSmall >= howBig ? howSmall : random(howBig - howSmall) + howSmall;
+}
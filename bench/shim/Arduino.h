@@ -0,0 +1,38 @@
+// Minimal Arduino API for building the LED pattern kernels on a host (see bench/led_bench.cpp).
+// Time comes from a fake clock the bench drives, and random() is AVR libc's generator.
+#ifndef BENCH_ARDUINO_H
+#define BENCH_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+#define pgm_read_dword(address) (*(const uint32_t*)(address))
+#define memcpy_P memcpy
+
+class __FlashStringHelper;
+#define F(string) (reinterpret_cast<const __FlashStringHelper*>(string))
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(x, low, high) ((x) < (low) ? (low) : ((x) > (high) ? (high) : (x)))
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+unsigned long millis();
+unsigned long micros();
+
+// Bench clock control
+void setFakeMillis(unsigned long ms);
+
+#endif // BENCH_ARDUINO_H
@@ -0,0 +1,277 @@
+#include "FastLED.h"
+
+/********************** LIB8TION *****************************/
+
+uint8_t scale8(uint8_t i, fract8 scale) {
+    return ((uint16_t)i * (1 + (uint16_t)scale)) >> 8;
+}
+
+uint8_t scale8_video(uint8_t i, fract8 scale) {
+    return (((uint16_t)i * (uint16_t)scale) >> 8) + ((i && scale) ? 1 : 0);
+}
+
+uint8_t qadd8(uint8_t i, uint8_t j) {
+    unsigned int t = i + j;
+    return t > 255 ? 255 : t;
+}
+
+uint8_t qsub8(uint8_t i, uint8_t j) {
+    int t = i - j;
+    return t < 0 ? 0 : t;
+}
+
+uint16_t scale16(uint16_t i, uint16_t scale) {
+    return ((uint32_t)i * (1 + (uint32_t)scale)) / 65536;
+}
+
+uint16_t scale16by8(uint16_t i, fract8 scale) {
+    return (i * (1 + (uint16_t)scale)) >> 8;
+}
+
+uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB) {
+    uint16_t partial = (a << 8) | b;
+    partial += (b * amountOfB);
+    partial -= (a * amountOfB);
+    return partial >> 8;
+}
+
+uint8_t lerp8by8(uint8_t a, uint8_t b, fract8 frac) {
+    if (b > a) {
+        return a + scale8(b - a, frac);
+    }
+    return a - scale8(a - b, frac);
+}
+
+int16_t sin16(uint16_t theta) {
+    static const uint16_t base[] = { 0, 6393, 12539, 18204, 23170, 27245, 30273, 32137 };
+    static const uint8_t slope[] = { 49, 48, 44, 38, 31, 23, 14, 4 };
+
+    uint16_t offset = (theta & 0x3FFF) >> 3;  // 0..2047
+    if (theta & 0x4000) {
+        offset = 2047 - offset;
+    }
+    uint8_t section = offset / 256;  // 0..7
+    uint16_t b = base[section];
+    uint8_t m = slope[section];
+    uint8_t secoffset8 = (uint8_t)(offset) / 2;
+    uint16_t mx = m * secoffset8;
+    int16_t y = mx + b;
+    if (theta & 0x8000) {
+        y = -y;
+    }
+    return y;
+}
+
+uint8_t sin8(uint8_t theta) {
+    static const uint8_t b_m16_interleave[] = { 0, 49, 49, 41, 90, 27, 117, 10 };
+
+    uint8_t offset = theta;
+    if (theta & 0x40) {
+        offset = (uint8_t)255 - offset;
+    }
+    offset &= 0x3F;  // 0..63
+
+    uint8_t secoffset = offset & 0x0F;  // 0..15
+    if (theta & 0x40) {
+        secoffset++;
+    }
+
+    uint8_t section = offset >> 4;  // 0..3
+    uint8_t s2 = section * 2;
+    const uint8_t* p = b_m16_interleave + s2;
+    uint8_t b = *p;
+    p++;
+    uint8_t m16 = *p;
+
+    uint8_t mx = (m16 * secoffset) >> 4;
+    int8_t y = mx + b;
+    if (theta & 0x80) {
+        y = -y;
+    }
+    return y + 128;
+}
+
+uint16_t beat88(uint16_t beatsPerMinute88, uint32_t timebase) {
+    return ((millis() - timebase) * beatsPerMinute88 * 280) >> 16;
+}
+
+uint16_t beatsin88(uint16_t beatsPerMinute88, uint16_t lowest, uint16_t highest,
+                   uint32_t timebase, uint16_t phaseOffset) {
+    uint16_t beat = beat88(beatsPerMinute88, timebase);
+    uint16_t beatsin = sin16(beat + phaseOffset) + 32768;
+    uint16_t rangewidth = highest - lowest;
+    uint16_t scaledbeat = scale16(beatsin, rangewidth);
+    return lowest + scaledbeat;
+}
+
+/********************** RANDOM *****************************/
+
+static uint16_t rand16seed = 1337;
+
+uint16_t random16() {
+    rand16seed = (rand16seed * 2053) + 13849;
+    return rand16seed;
+}
+
+uint16_t random16(uint16_t lim) {
+    uint32_t p = (uint32_t)lim * (uint32_t)random16();
+    return p >> 16;
+}
+
+uint8_t random8() {
+    rand16seed = (rand16seed * 2053) + 13849;
+    return (uint8_t)(((uint8_t)(rand16seed & 0xFF)) + ((uint8_t)(rand16seed >> 8)));
+}
+
+uint8_t random8(uint8_t lim) {
+    return (random8() * lim) >> 8;
+}
+
+uint8_t random8(uint8_t min, uint8_t lim) {
+    return random8(lim - min) + min;
+}
+
+void random16_set_seed(uint16_t seed) {
+    rand16seed = seed;
+}
+
+/********************** COLORS *****************************/
+
+void hsv2rgb_rainbow(const CHSV& hsv, CRGB& rgb) {
+    uint8_t hue = hsv.hue;
+    uint8_t sat = hsv.sat;
+    uint8_t val = hsv.val;
+
+    uint8_t offset8 = (hue & 0x1F) << 3;  // 0..248
+    uint8_t third = scale8(offset8, (256 / 3));  // max = 85
+
+    uint8_t r, g, b;
+    if (!(hue & 0x80)) {
+        if (!(hue & 0x40)) {
+            if (!(hue & 0x20)) {
+                r = 255 - third; g = third; b = 0;           // Red -> orange
+            } else {
+                r = 171; g = 85 + third; b = 0;              // Orange -> yellow
+            }
+        } else {
+            if (!(hue & 0x20)) {
+                uint8_t twothirds = scale8(offset8, ((256 * 2) / 3));
+                r = 171 - twothirds; g = 170 + third; b = 0; // Yellow -> green
+            } else {
+                r = 0; g = 255 - third; b = third;           // Green -> aqua
+            }
+        }
+    } else {
+        if (!(hue & 0x40)) {
+            if (!(hue & 0x20)) {
+                uint8_t twothirds = scale8(offset8, ((256 * 2) / 3));
+                r = 0; g = 171 - twothirds; b = 85 + twothirds;  // Aqua -> blue
+            } else {
+                r = third; g = 0; b = 255 - third;           // Blue -> purple
+            }
+        } else {
+            if (!(hue & 0x20)) {
+                r = 85 + third; g = 0; b = 171 - third;      // Purple -> pink
+            } else {
+                r = 170 + third; g = 0; b = 85 - third;      // Pink -> red
+            }
+        }
+    }
+
+    if (sat != 255) {
+        if (sat == 0) {
+            r = 255; g = 255; b = 255;
+        } else {
+            uint8_t desat = 255 - sat;
+            desat = scale8_video(desat, desat);
+            uint8_t satscale = 255 - desat;
+            if (r) r = scale8(r, satscale) + 1;
+            if (g) g = scale8(g, satscale) + 1;
+            if (b) b = scale8(b, satscale) + 1;
+            r += desat;
+            g += desat;
+            b += desat;
+        }
+    }
+
+    if (val != 255) {
+        val = scale8_video(val, val);
+        if (val == 0) {
+            r = 0; g = 0; b = 0;
+        } else {
+            if (r) r = scale8(r, val) + 1;
+            if (g) g = scale8(g, val) + 1;
+            if (b) b = scale8(b, val) + 1;
+        }
+    }
+
+    rgb.r = r;
+    rgb.g = g;
+    rgb.b = b;
+}
+
+CRGB& nblend(CRGB& existing, const CRGB& overlay, fract8 amountOfOverlay) {
+    if (amountOfOverlay == 0) {
+        return existing;
+    }
+    if (amountOfOverlay == 255) {
+        existing = overlay;
+        return existing;
+    }
+    existing.r = blend8(existing.r, overlay.r, amountOfOverlay);
+    existing.g = blend8(existing.g, overlay.g, amountOfOverlay);
+    existing.b = blend8(existing.b, overlay.b, amountOfOverlay);
+    return existing;
+}
+
+CRGB blend(const CRGB& p1, const CRGB& p2, fract8 amountOfP2) {
+    CRGB nu(p1);
+    nblend(nu, p2, amountOfP2);
+    return nu;
+}
+
+void fill_solid(CRGB* leds, int numToFill, const CRGB& color) {
+    for (int i = 0; i < numToFill; i++) {
+        leds[i] = color;
+    }
+}
+
+void nscale8(CRGB* leds, uint16_t numLeds, uint8_t scale) {
+    for (uint16_t i = 0; i < numLeds; i++) {
+        leds[i].nscale8(scale);
+    }
+}
+
+void fadeToBlackBy(CRGB* leds, uint16_t numLeds, uint8_t fadeBy) {
+    nscale8(leds, numLeds, 255 - fadeBy);
+}
+
+CRGB ColorFromPalette(const CRGBPalette16& pal, uint8_t index, uint8_t brightness, TBlendType blendType) {
+    uint8_t hi4 = index >> 4;
+    uint8_t lo4 = index & 0x0F;
+    const CRGB* entry = &(pal[0]) + hi4;
+    uint8_t red1 = entry->red;
+    uint8_t green1 = entry->green;
+    uint8_t blue1 = entry->blue;
+
+    if (lo4 && blendType != NOBLEND) {
+        entry = hi4 == 15 ? &(pal[0]) : entry + 1;
+        uint8_t f2 = lo4 << 4;
+        uint8_t f1 = 255 - f2;
+        red1 = scale8(red1, f1) + scale8(entry->red, f2);
+        green1 = scale8(green1, f1) + scale8(entry->green, f2);
+        blue1 = scale8(blue1, f1) + scale8(entry->blue, f2);
+    }
+
+    if (brightness != 255) {
+        if (brightness) {
+            ++brightness;  // adjust for rounding
+            red1 = scale8(red1, brightness);
+            green1 = scale8(green1, brightness);
+            blue1 = scale8(blue1, brightness);
+        } else {
+            red1 = green1 = blue1 = 0;
+        }
+    }
+    return CRGB(red1, green1, blue1);
+}
@@ -0,0 +1,125 @@
+// The subset of FastLED the LED pattern kernels use, ported from FastLED's portable C paths
+// (FASTLED_SCALE8_FIXED and FASTLED_BLEND_FIXED) so integer kernels render as they do on the AVR.
+#ifndef BENCH_FASTLED_H
+#define BENCH_FASTLED_H
+
+#include <Arduino.h>
+
+typedef uint8_t fract8;
+
+struct CHSV {
+    union {
+        struct {
+            union { uint8_t hue; uint8_t h; };
+            union { uint8_t sat; uint8_t s; };
+            union { uint8_t val; uint8_t v; };
+        };
+        uint8_t raw[3];
+    };
+    CHSV() {}
+    CHSV(uint8_t ih, uint8_t is, uint8_t iv) : hue(ih), sat(is), val(iv) {}
+};
+
+struct CRGB;
+void hsv2rgb_rainbow(const CHSV& hsv, CRGB& rgb);
+
+uint8_t scale8(uint8_t i, fract8 scale);
+uint8_t scale8_video(uint8_t i, fract8 scale);
+
+struct CRGB {
+    union {
+        struct {
+            union { uint8_t r; uint8_t red; };
+            union { uint8_t g; uint8_t green; };
+            union { uint8_t b; uint8_t blue; };
+        };
+        uint8_t raw[3];
+    };
+
+    enum HTMLColorCode {
+        Black = 0x000000,
+        White = 0xFFFFFF
+    };
+
+    CRGB() {}
+    CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+    CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b(colorcode & 0xFF) {}
+    CRGB(HTMLColorCode colorcode) : CRGB((uint32_t)colorcode) {}
+    CRGB(const CHSV& hsv) { hsv2rgb_rainbow(hsv, *this); }
+
+    CRGB& operator=(const CHSV& hsv) { hsv2rgb_rainbow(hsv, *this); return *this; }
+    uint8_t& operator[](uint8_t x) { return raw[x]; }
+    const uint8_t& operator[](uint8_t x) const { return raw[x]; }
+    bool operator==(const CRGB& rhs) const { return r == rhs.r && g == rhs.g && b == rhs.b; }
+    bool operator!=(const CRGB& rhs) const { return !(*this == rhs); }
+
+    CRGB& nscale8(uint8_t scale) {
+        r = scale8(r, scale);
+        g = scale8(g, scale);
+        b = scale8(b, scale);
+        return *this;
+    }
+    CRGB& nscale8_video(uint8_t scale) {
+        r = scale8_video(r, scale);
+        g = scale8_video(g, scale);
+        b = scale8_video(b, scale);
+        return *this;
+    }
+    CRGB& fadeToBlackBy(uint8_t fadefactor) { return nscale8(255 - fadefactor); }
+};
+
+// lib8tion
+uint8_t qadd8(uint8_t i, uint8_t j);
+uint8_t qsub8(uint8_t i, uint8_t j);
+uint16_t scale16(uint16_t i, uint16_t scale);
+uint16_t scale16by8(uint16_t i, fract8 scale);
+uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB);
+uint8_t lerp8by8(uint8_t a, uint8_t b, fract8 frac);
+int16_t sin16(uint16_t theta);
+uint8_t sin8(uint8_t theta);
+uint16_t beat88(uint16_t beatsPerMinute88, uint32_t timebase = 0);
+uint16_t beatsin88(uint16_t beatsPerMinute88, uint16_t lowest = 0, uint16_t highest = 65535,
+                   uint32_t timebase = 0, uint16_t phaseOffset = 0);
+
+// Random numbers, FastLED's 16-bit LCG
+uint8_t random8();
+uint8_t random8(uint8_t lim);
+uint8_t random8(uint8_t min, uint8_t lim);
+uint16_t random16();
+uint16_t random16(uint16_t lim);
+void random16_set_seed(uint16_t seed);
+
+// Colors
+CRGB& nblend(CRGB& existing, const CRGB& overlay, fract8 amountOfOverlay);
+CRGB blend(const CRGB& p1, const CRGB& p2, fract8 amountOfP2);
+void fill_solid(CRGB* leds, int numToFill, const CRGB& color);
+void nscale8(CRGB* leds, uint16_t numLeds, uint8_t scale);
+void fadeToBlackBy(CRGB* leds, uint16_t numLeds, uint8_t fadeBy);
+
+// Palettes
+typedef const uint32_t TProgmemRGBPalette16[16];
+
+enum TBlendType {
+    NOBLEND = 0,
+    LINEARBLEND = 1
+};
+
+struct CRGBPalette16 {
+    CRGB entries[16];
+
+    CRGBPalette16() {}
+    CRGBPalette16(const TProgmemRGBPalette16& rhs) { *this = rhs; }
+    CRGBPalette16& operator=(const TProgmemRGBPalette16& rhs) {
+        for (uint8_t i = 0; i < 16; i++) {
+            entries[i] = CRGB((uint32_t)pgm_read_dword(rhs + i));
+        }
+        return *this;
+    }
+    CRGB& operator[](uint8_t x) { return entries[x]; }
+    const CRGB& operator[](uint8_t x) const { return entries[x]; }
+};
+
+CRGB ColorFromPalette(const CRGBPalette16& pal, uint8_t index, uint8_t brightness = 255,
+                      TBlendType blendType = LINEARBLEND);
+
+#endif // BENCH_FASTLED_H
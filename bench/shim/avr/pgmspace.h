@@ -0,0 +1,2 @@
+// Flash is ordinary memory on the host
+#include <Arduino.h>
@@ -6,13 +6,14 @@
  * SCL: A5 (Pin 28)
  * 
  * Button Pins:
- * S1: D8
- * S2: D9
- * S3: D10  
- * S4: D11
+ * S1: D7
+ * S2: D8
+ * S3: D9  
+ * S4: D10
  */
 
 #include "ButtonDisplay.h"
+#include "Crc16.h"
 #include <Wire.h>
 #include <U8glib.h>
 #include <Arduino.h>
@@ -21,6 +22,8 @@
 #define DISPLAY_HEIGHT 64  // Display height in pixels
 #define SCREEN_ADDRESS 0x3C
 
+static const uint8_t BUTTON_PINS[BUTTON_COUNT] = { BTN1_PIN, BTN2_PIN, BTN3_PIN, BTN4_PIN };
+
 ButtonDisplay::ButtonDisplay(const uint8_t* font) : display(U8G_I2C_OPT_NONE), defaultFont(font) {
     buttonsInitialized = false;
     displayInitialized = false;
@@ -28,18 +31,19 @@ ButtonDisplay::ButtonDisplay(const uint8_t* font) : display(U8G_I2C_OPT_NONE), d
     cursorY = 0;
     charHeight = 8;
     needsUpdate = false;
-    lastText[0] = '\0';
+    drawing = false;
+    fullRedraw = true;
     defaultFont = font;
     textLines[0][0] = '\0';
     numLines = 0;
+    numShownLines = 0;
+    numMessages = 0;
+    messageStart = 0;
 }
 
 void ButtonDisplay::initButtons() {
     if (!buttonsInitialized) {
-        pinMode(BTN1_PIN, INPUT_PULLUP);
-        pinMode(BTN2_PIN, INPUT_PULLUP);
-        pinMode(BTN3_PIN, INPUT_PULLUP);
-        pinMode(BTN4_PIN, INPUT_PULLUP);
+        buttons.begin(BUTTON_PINS);
         buttonsInitialized = true;
     }
 }
@@ -69,7 +73,8 @@ void ButtonDisplay::initDisplay() {
         cursorY = 0;
         displayInitialized = true;
         numLines = 0;
-        lastText[0] = '\0';
+        textLines[0][0] = '\0';
+        fullRedraw = true;
     }
 }
 
@@ -78,38 +83,197 @@ void ButtonDisplay::begin() {
     initDisplay();
 }
 
+// Every redraw starts from a blank picture, so clearing only drops the stored lines
 void ButtonDisplay::clearDisplay() {
     cursorX = 0;
     cursorY = 0;
     numLines = 0;  // Reset line counter
-    display.firstPage();
-    do {
-        // Empty draw - clears display
-    } while(display.nextPage());
+    textLines[0][0] = '\0';
+    needsUpdate = true;
 }
 
 void ButtonDisplay::updateDisplay() {
-    if (needsUpdate) {
-        display.firstPage();
-        do {
-            // Calculate total height of all lines
-            uint8_t totalHeight = numLines * charHeight;
-            
-            // Calculate starting Y position to center vertically
-            uint8_t startY = (DISPLAY_HEIGHT - totalHeight) / 2;
-            uint8_t y = startY;
-            
-            // Draw all stored lines
-            for (uint8_t i = 0; i < numLines; i++) {
-                // Calculate width of text and center position horizontally
-                uint8_t strWidth = display.getStrWidth(textLines[i]);
-                uint8_t x = (DISPLAY_WIDTH - strWidth) / 2;
-                display.drawStr(x, y, textLines[i]);
-                y += charHeight;
-            }
-        } while(display.nextPage());
+    needsUpdate = true;
+}
+
+bool ButtonDisplay::tick() {
+    if (!displayInitialized) {
+        return false;
+    }
+    expireMessages();
+    if (!drawing) {
+        if (!needsUpdate) {
+            return false;
+        }
+        // Lines changed during a picture loop are picked up by the next one
         needsUpdate = false;
+        if (!beginRedraw()) {
+            return false;
+        }
+        drawing = true;
+        display.firstPage();
+    }
+
+    // Step over the pages that didn't change without drawing or sending them
+    uint8_t page = display.getU8g()->current_page.y0 / DISPLAY_PAGE_HEIGHT;
+    while (dirtyX0[page] > dirtyX1[page]) {
+        if (!advancePage()) {
+            drawing = false;
+            return needsUpdate;
+        }
+        page++;
+    }
+    drawPage();
+    sendPage(dirtyX0[page], dirtyX1[page]);
+    drawing = advancePage();
+    return drawing || needsUpdate;
+}
+
+void ButtonDisplay::expireMessages() {
+    if (numMessages == 0 || millis() - messageStart < messages[0].duration) {
+        return;
+    }
+    numMessages--;
+    memmove(&messages[0], &messages[1], numMessages * sizeof(Message));
+    messageStart = millis();
+    needsUpdate = true;
+}
+
+uint8_t ButtonDisplay::viewLineCount() const {
+    return numMessages > 0 ? 1 : numLines;
+}
+
+const char* ButtonDisplay::viewText(uint8_t line) const {
+    return numMessages > 0 ? messages[0].text : textLines[line];
+}
+
+uint8_t ButtonDisplay::viewWidth(uint8_t line) const {
+    return numMessages > 0 ? messages[0].width : lineWidths[line];
+}
+
+bool ButtonDisplay::sameLine(const ShownLine& a, const ShownLine& b) {
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.crc == b.crc;
+}
+
+// Diffs the stored lines against what was last sent, marking the columns to resend on each
+// page. Returns false if nothing changed.
+bool ButtonDisplay::beginRedraw() {
+    bool changed = fullRedraw;
+    memset(dirtyX0, 0xFF, sizeof(dirtyX0));
+    memset(dirtyX1, 0, sizeof(dirtyX1));
+    if (fullRedraw) {
+        memset(dirtyX0, 0, sizeof(dirtyX0));
+        memset(dirtyX1, DISPLAY_WIDTH - 1, sizeof(dirtyX1));
+        fullRedraw = false;
+    }
+
+    // Lines are centered vertically as a block and each one horizontally
+    ShownLine lines[MAX_LINES];
+    uint8_t count = viewLineCount();
+    uint8_t y = (DISPLAY_HEIGHT - count * charHeight) / 2;
+    for (uint8_t i = 0; i < count; i++) {
+        const char* text = viewText(i);
+        lines[i].x = (DISPLAY_WIDTH - viewWidth(i)) / 2;
+        lines[i].y = y;
+        lines[i].width = viewWidth(i);
+        lines[i].crc = crc16Update(CRC16_INIT, (const uint8_t*)text, strlen(text));
+        y += charHeight;
+    }
+
+    // A line that moved or changed dirties both where it was and where it is now
+    for (uint8_t i = 0; i < count; i++) {
+        bool shown = false;
+        for (uint8_t j = 0; j < numShownLines && !shown; j++) {
+            shown = sameLine(lines[i], shownLines[j]);
+        }
+        if (!shown) {
+            markDirty(lines[i].x, lines[i].y, lines[i].width);
+            changed = true;
+        }
     }
+    for (uint8_t j = 0; j < numShownLines; j++) {
+        bool kept = false;
+        for (uint8_t i = 0; i < count && !kept; i++) {
+            kept = sameLine(lines[i], shownLines[j]);
+        }
+        if (!kept) {
+            markDirty(shownLines[j].x, shownLines[j].y, shownLines[j].width);
+            changed = true;
+        }
+    }
+
+    memcpy(shownLines, lines, count * sizeof(ShownLine));
+    numShownLines = count;
+    return changed;
+}
+
+void ButtonDisplay::markDirty(uint8_t x, uint8_t y, uint8_t width) {
+    if (width == 0 || y >= DISPLAY_HEIGHT) {
+        return;
+    }
+    uint8_t x1 = min(x + width - 1, DISPLAY_WIDTH - 1);
+    uint8_t lastPage = min(y + charHeight - 1, DISPLAY_HEIGHT - 1) / DISPLAY_PAGE_HEIGHT;
+    for (uint8_t page = y / DISPLAY_PAGE_HEIGHT; page <= lastPage; page++) {
+        dirtyX0[page] = min(dirtyX0[page], x);
+        dirtyX1[page] = max(dirtyX1[page], x1);
+    }
+}
+
+// Whether the stored lines are still the ones beginRedraw() laid out
+bool ButtonDisplay::shownLinesCurrent() const {
+    if (viewLineCount() != numShownLines) {
+        return false;
+    }
+    for (uint8_t i = 0; i < numShownLines; i++) {
+        const char* text = viewText(i);
+        if (viewWidth(i) != shownLines[i].width
+            || crc16Update(CRC16_INIT, (const uint8_t*)text, strlen(text)) != shownLines[i].crc) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Draws the stored lines into the current page; U8glib clips them to it. Lines that changed
+// since the redraw began leave this one a mix of old and new text that shownLines doesn't
+// describe, so the next redraw repaints everything.
+void ButtonDisplay::drawPage() {
+    if (!fullRedraw && !shownLinesCurrent()) {
+        fullRedraw = true;
+    }
+    for (uint8_t i = 0; i < numShownLines; i++) {
+        display.drawStr(shownLines[i].x, shownLines[i].y, viewText(i));
+    }
+}
+
+// Sends columns x0-x1 of the current page. The same transfer as U8glib's SSD1306 driver,
+// but starting at x0 rather than always sending the whole 128 byte row.
+void ButtonDisplay::sendPage(uint8_t x0, uint8_t x1) {
+    u8g_t* u8g = display.getU8g();
+    u8g_dev_t* dev = u8g->dev;
+    u8g_pb_t* pb = (u8g_pb_t*)dev->dev_mem;
+
+    u8g_SetChipSelect(u8g, dev, 1);
+    u8g_SetAddress(u8g, dev, 0);           // Command mode
+    u8g_WriteByte(u8g, dev, 0x10 | (x0 >> 4));      // Column, high nibble
+    u8g_WriteByte(u8g, dev, 0x00 | (x0 & 0x0F));    // Column, low nibble
+    u8g_WriteByte(u8g, dev, 0xB0 | pb->p.page);     // Page
+    u8g_SetAddress(u8g, dev, 1);           // Data mode
+    u8g_WriteSequence(u8g, dev, x1 - x0 + 1, (uint8_t*)pb->buf + x0);
+    u8g_SetChipSelect(u8g, dev, 0);
+}
+
+// Moves the picture loop on to the next page without sending the current one, as
+// U8glib's nextPage() would after sending it. Returns false after the last page.
+bool ButtonDisplay::advancePage() {
+    u8g_t* u8g = display.getU8g();
+    u8g_pb_t* pb = (u8g_pb_t*)u8g->dev->dev_mem;
+    if (!u8g_page_Next(&pb->p)) {
+        return false;
+    }
+    u8g_pb_Clear(pb);
+    u8g_pb_GetPageBox(pb, &u8g->current_page);
+    return true;
 }
 
 void ButtonDisplay::setCursor(uint8_t x, uint8_t y) {
@@ -117,11 +281,12 @@ void ButtonDisplay::setCursor(uint8_t x, uint8_t y) {
     if (y < DISPLAY_HEIGHT) cursorY = y;     // Added bounds checking
 }
 
+// Adds to the line being built; println() finishes it
 void ButtonDisplay::print(const char* text) {
-    // Store position and text for next update
-    strncpy(lastText, text, sizeof(lastText)-1);
-    lastText[sizeof(lastText)-1] = '\0';
-    display.drawStr(cursorX, cursorY, text);
+    if (numLines < MAX_LINES) {
+        char* line = textLines[numLines];
+        strncat(line, text, sizeof(textLines[0]) - 1 - strlen(line));
+    }
     cursorX += display.getStrWidth(text);
     needsUpdate = true;
 }
@@ -137,10 +302,16 @@ void ButtonDisplay::print(byte number) {
 }
 
 void ButtonDisplay::println(const char* text) {
-    if (text != nullptr && numLines < MAX_LINES) {
-        strncpy(textLines[numLines], text, sizeof(textLines[0])-1);
-        textLines[numLines][sizeof(textLines[0])-1] = '\0';
+    if (text != nullptr) {
+        print(text);
+    }
+    if (numLines < MAX_LINES && textLines[numLines][0] != '\0') {
+        // Lay the line out now rather than on every page of every redraw
+        lineWidths[numLines] = display.getStrWidth(textLines[numLines]);
         numLines++;
+        if (numLines < MAX_LINES) {
+            textLines[numLines][0] = '\0';
+        }
     }
     cursorX = 0;
     cursorY += charHeight;
@@ -152,38 +323,56 @@ void ButtonDisplay::println(const char* text) {
 
 void ButtonDisplay::setFont(const uint8_t* font) {
     display.setFont(font);
+    fullRedraw = true;
 }
 
 bool ButtonDisplay::isButton1Pressed() {
-    return !digitalRead(BTN1_PIN);
+    return buttons.isPressed(0);
 }
 
 bool ButtonDisplay::isButton2Pressed() {
-    return !digitalRead(BTN2_PIN);
+    return buttons.isPressed(1);
 }
 
 bool ButtonDisplay::isButton3Pressed() {
-    return !digitalRead(BTN3_PIN);
+    return buttons.isPressed(2);
 }
 
 bool ButtonDisplay::isButton4Pressed() {
-    return !digitalRead(BTN4_PIN);
+    return buttons.isPressed(3);
 }
 
-void ButtonDisplay::showMessage(const char* message, uint16_t duration) {
-    clearDisplay();
-    setCursor(0, 0);
-    print(message);
-    updateDisplay();  // Add explicit update
-    if (duration > 0) {
-        delay(duration);
+void ButtonDisplay::showMessage(const char* message, uint16_t duration, uint8_t priority) {
+    // Behind the last message of the same or higher priority; a full queue drops its lowest
+    uint8_t slot = 0;
+    while (slot < numMessages && messages[slot].priority >= priority) {
+        slot++;
+    }
+    if (slot >= DISPLAY_MESSAGE_SLOTS) {
+        Serial.println(F("Display message queue full"));
+        return;
+    }
+    if (numMessages == DISPLAY_MESSAGE_SLOTS) {
+        numMessages--;
+    }
+    memmove(&messages[slot + 1], &messages[slot], (numMessages - slot) * sizeof(Message));
+    numMessages++;
+
+    Message& entry = messages[slot];
+    strncpy(entry.text, message, sizeof(entry.text) - 1);
+    entry.text[sizeof(entry.text) - 1] = '\0';
+    entry.width = display.getStrWidth(entry.text);
+    entry.priority = priority;
+    entry.duration = duration;
+    if (slot == 0) {
+        // Preempts whatever was on screen, which gets its full time again later
+        messageStart = millis();
+        needsUpdate = true;
     }
 }
 
 void ButtonDisplay::showError(const char* errorMessage) {
-    clearDisplay();
-    setCursor(0, 0);
-    println(errorMessage);
+    showMessage(errorMessage, DISPLAY_ERROR_DURATION, DISPLAY_PRIORITY_ERROR);
 }
 
 U8GLIB_SSD1306_128X64* ButtonDisplay::getDisplay() {
@@ -4,10 +4,20 @@
 #include <Wire.h>
 #include <U8glib.h>
 #include <Arduino.h>
+#include "ButtonInput.h"
 
 #define DISPLAY_WIDTH 128
 #define DISPLAY_HEIGHT 64
 #define SCREEN_ADDRESS 0x3C
+#define DISPLAY_PAGE_HEIGHT 8   // SSD1306 page: 8 pixel rows, one byte per column
+#define DISPLAY_PAGES (DISPLAY_HEIGHT / DISPLAY_PAGE_HEIGHT)
+
+// Timed messages shown over the main view
+#define DISPLAY_MESSAGE_SLOTS 3
+#define DISPLAY_MESSAGE_LENGTH 16
+#define DISPLAY_PRIORITY_INFO 0
+#define DISPLAY_PRIORITY_ERROR 1
+#define DISPLAY_ERROR_DURATION 2000
 
 #define BTN1_PIN 7
 #define BTN2_PIN 8
@@ -18,38 +28,89 @@
 class ButtonDisplay {
 private:
     U8GLIB_SSD1306_128X64 display;
+    ButtonInput buttons;
     bool buttonsInitialized;
     bool displayInitialized;
     uint8_t cursorX;
     uint8_t cursorY;
     uint8_t charHeight;
     bool needsUpdate;
-    char lastText[16];
+    bool drawing;       // A picture loop is under way, one page per tick()
+    bool fullRedraw;    // What's on screen is unknown, so every page is sent
     const uint8_t* defaultFont;
     static const int MAX_LINES = 8;  // Maximum number of lines to store
-    char textLines[MAX_LINES][16];
+    char textLines[MAX_LINES][16];   // textLines[numLines] is the line print() is building
+    uint8_t lineWidths[MAX_LINES];   // Laid out once, by println()
     uint8_t numLines;
 
+    // A line as it was last sent, to diff the next redraw against
+    struct ShownLine {
+        uint8_t x;
+        uint8_t y;
+        uint8_t width;
+        uint16_t crc;
+    };
+    // A timed message; the queue is kept highest priority first, oldest first within a priority
+    struct Message {
+        char text[DISPLAY_MESSAGE_LENGTH];
+        uint8_t width;
+        uint8_t priority;
+        uint16_t duration;  // ms
+    };
+    Message messages[DISPLAY_MESSAGE_SLOTS];
+    uint8_t numMessages;
+    unsigned long messageStart;   // When messages[0] went on screen
+
+    ShownLine shownLines[MAX_LINES];
+    uint8_t numShownLines;
+    // Columns to send on each page in the current redraw; clean pages have x0 > x1
+    uint8_t dirtyX0[DISPLAY_PAGES];
+    uint8_t dirtyX1[DISPLAY_PAGES];
+
     void initButtons();
     void initDisplay();
+    void expireMessages();
+    // What's on screen: the first queued message, otherwise the stored lines
+    uint8_t viewLineCount() const;
+    const char* viewText(uint8_t line) const;
+    uint8_t viewWidth(uint8_t line) const;
+    static bool sameLine(const ShownLine& a, const ShownLine& b);
+    bool beginRedraw();
+    bool shownLinesCurrent() const;
+    void markDirty(uint8_t x, uint8_t y, uint8_t width);
+    void drawPage();
+    void sendPage(uint8_t x0, uint8_t x1);
+    bool advancePage();
 
 public:
     ButtonDisplay(const uint8_t* font);
     void begin();
+    // Drawing only changes the stored lines (the main view); tick() sends them to the display a
+    // page at a time
     void clearDisplay();
     void updateDisplay();
+    // Expires messages, then sends the next changed page of a pending redraw, at most 1/8 of
+    // the screen and only the columns that changed; call once per loop(). Returns true while a
+    // redraw is still under way.
+    bool tick();
     void setCursor(uint8_t x, uint8_t y);
     void print(const char* text);
     void print(int number);
     void print(byte number);
     void println(const char* text = nullptr);
     void setFont(const uint8_t* font);
+    // Button events in order, debounced with auto-repeat (see ButtonInput.h); buttons are 0-3
+    bool pollButton(ButtonEvent& event) { return buttons.poll(event); }
+    // Debounced levels
     bool isButton1Pressed();
     bool isButton2Pressed();
     bool isButton3Pressed();
     bool isButton4Pressed();
-    void showMessage(const char* message, uint16_t duration = 2000);
+    // Queue a message to show over the main view for duration ms; a higher priority one
+    // preempts the one on screen. Nothing blocks: tick() expires it and restores the view.
+    void showMessage(const char* message, uint16_t duration = 2000, uint8_t priority = DISPLAY_PRIORITY_INFO);
     void showError(const char* errorMessage);
+    bool isShowingMessage() const { return numMessages > 0; }
     U8GLIB_SSD1306_128X64* getDisplay();
 };
 
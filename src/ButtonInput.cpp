@@ -0,0 +1,154 @@
+#include "ButtonInput.h"
+#include "PinChange.h"
+#include <avr/interrupt.h>
+
+// The instance the interrupts drive
+static ButtonInput* activeInput = nullptr;
+
+ButtonInput::ButtonInput() {
+    numPorts = 0;
+    raw = 0;
+    pressed = 0;
+    ignored = 0;
+    settleTicks = 0;
+    eventHead = 0;
+    eventTail = 0;
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        portOf[i] = 0;
+        masks[i] = 0;
+        repeatTicks[i] = 0;
+        repeatInterval[i] = 0;
+        repeatCount[i] = 0;
+    }
+}
+
+void ButtonInput::begin(const uint8_t* pins) {
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        pinMode(pins[i], INPUT_PULLUP);
+        volatile uint8_t* port = portInputRegister(digitalPinToPort(pins[i]));
+        uint8_t index = 0;
+        while (index < numPorts && ports[index] != port) {
+            index++;
+        }
+        if (index == numPorts) {
+            if (numPorts == 2) {
+                Serial.println(F("Buttons span more than two ports"));
+                return;
+            }
+            ports[numPorts++] = port;
+        }
+        portOf[i] = index;
+        masks[i] = digitalPinToBitMask(pins[i]);
+    }
+
+    activeInput = this;
+    raw = readButtons();
+    ignored = raw;      // Buttons already held at startup don't press, or repeat
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        if (!attachPinChange(pins[i], onPinChange)) {
+            Serial.println(F("No pin change interrupt for button"));
+        }
+    }
+}
+
+bool ButtonInput::poll(ButtonEvent& event) {
+    if (eventTail == eventHead) {
+        return false;
+    }
+    event = events[eventTail];
+    eventTail = (eventTail + 1) & (BUTTON_EVENT_QUEUE - 1);
+    return true;
+}
+
+uint8_t ButtonInput::readButtons() const {
+    uint8_t levels[2];
+    for (uint8_t i = 0; i < numPorts; i++) {
+        levels[i] = *ports[i];
+    }
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        if (!(levels[portOf[i]] & masks[i])) {   // Active low
+            mask |= _BV(i);
+        }
+    }
+    return mask;
+}
+
+void ButtonInput::queue(uint8_t button, ButtonEventType type, uint8_t repeats) {
+    uint8_t next = (eventHead + 1) & (BUTTON_EVENT_QUEUE - 1);
+    if (next == eventTail) {
+        return;
+    }
+    events[eventHead].button = button;
+    events[eventHead].type = type;
+    events[eventHead].repeats = repeats;
+    eventHead = next;
+}
+
+// A pin moved, or bounced: (re)start the settle time
+void ButtonInput::onPinChange() {
+    if (activeInput == nullptr) {
+        return;
+    }
+    uint8_t buttons = activeInput->readButtons();
+    if (buttons != activeInput->raw || activeInput->settleTicks) {
+        activeInput->raw = buttons;
+        activeInput->settleTicks = BUTTON_DEBOUNCE_MS;
+        startTick();
+    }
+}
+
+void ButtonInput::onTick() {
+    if (settleTicks && --settleTicks == 0) {
+        ignored &= raw;
+        uint8_t changed = (raw & ~ignored) ^ pressed;
+        pressed = raw & ~ignored;
+        for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+            if (!(changed & _BV(i))) {
+                continue;
+            }
+            if (pressed & _BV(i)) {
+                repeatTicks[i] = BUTTON_REPEAT_DELAY;
+                repeatInterval[i] = BUTTON_REPEAT_INTERVAL;
+                repeatCount[i] = 0;
+                queue(i, BUTTON_PRESSED, 0);
+            } else {
+                queue(i, BUTTON_RELEASED, repeatCount[i]);
+            }
+        }
+    }
+
+    // Auto-repeat held buttons, a quarter faster each time
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        if ((pressed & _BV(i)) && --repeatTicks[i] == 0) {
+            if (repeatCount[i] < 255) {
+                repeatCount[i]++;
+            }
+            queue(i, BUTTON_REPEATED, repeatCount[i]);
+            repeatTicks[i] = repeatInterval[i];
+            repeatInterval[i] = max(repeatInterval[i] - repeatInterval[i] / 4, BUTTON_REPEAT_MIN_INTERVAL);
+        }
+    }
+
+    if (!settleTicks && !pressed) {
+        stopTick();
+    }
+}
+
+// Timer0 overflows every 1.024ms for millis(); its compare match A fires once per overflow too
+// and is otherwise unused, so it makes a free 1ms tick. Halfway through the count keeps it clear
+// of the overflow interrupt.
+void ButtonInput::startTick() {
+    OCR0A = 0x80;
+    TIMSK0 |= _BV(OCIE0A);
+}
+
+void ButtonInput::stopTick() {
+    TIMSK0 &= ~_BV(OCIE0A);
+}
+
+ISR(TIMER0_COMPA_vect) {
+    if (activeInput != nullptr) {
+        activeInput->onTick();
+    }
+}
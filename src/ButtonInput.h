@@ -0,0 +1,70 @@
+#ifndef BUTTONINPUT_H
+#define BUTTONINPUT_H
+
+#include <Arduino.h>
+
+// Debounced, edge-triggered buttons. Pin change interrupts (see PinChange.h) note when a pin
+// moves; a 1ms tick on Timer0's spare compare match waits for it to settle, then queues press
+// and release events, and repeat events while a button is held, coming faster the longer it is.
+// The tick only runs while a button is settling or held, so idle buttons cost nothing.
+#define BUTTON_COUNT 4
+#define BUTTON_DEBOUNCE_MS 20          // A pin must be stable this long before its edge counts
+#define BUTTON_REPEAT_DELAY 400        // ms held before the first repeat
+#define BUTTON_REPEAT_INTERVAL 200     // ms to the second repeat; each later one comes a quarter sooner
+#define BUTTON_REPEAT_MIN_INTERVAL 40  // ...down to this
+#define BUTTON_EVENT_QUEUE 8           // Power of two; events beyond it are dropped
+
+enum ButtonEventType : uint8_t {
+    BUTTON_PRESSED,
+    BUTTON_RELEASED,
+    BUTTON_REPEATED
+};
+
+struct ButtonEvent {
+    uint8_t button;     // Index into the pins passed to begin()
+    ButtonEventType type;
+    uint8_t repeats;    // Repeats since the press, for BUTTON_REPEATED
+};
+
+// One instance per sketch: the interrupts drive whichever was begun
+class ButtonInput {
+public:
+    ButtonInput();
+
+    // Pins in button order, active low with the internal pull-ups
+    void begin(const uint8_t* pins);
+    // Takes the oldest queued event; returns false if there is none
+    bool poll(ButtonEvent& event);
+    // Debounced level
+    bool isPressed(uint8_t button) const { return pressed & _BV(button); }
+
+    // Interrupt handlers
+    static void onPinChange();
+    void onTick();
+
+private:
+    // Reads the buttons as a pressed mask, one read per port they are on
+    uint8_t readButtons() const;
+    void queue(uint8_t button, ButtonEventType type, uint8_t repeats);
+    static void startTick();
+    static void stopTick();
+
+    volatile uint8_t* ports[2];        // Input registers: the display buttons are on PORTD and PORTB
+    uint8_t numPorts;
+    uint8_t portOf[BUTTON_COUNT];      // Index into ports
+    uint8_t masks[BUTTON_COUNT];
+
+    volatile uint8_t raw;              // Pressed mask at the last pin change
+    volatile uint8_t pressed;          // Debounced pressed mask
+    volatile uint8_t ignored;          // Held since begin(); they press once released and pressed again
+    volatile uint8_t settleTicks;      // Ticks until raw is taken as pressed; 0 when settled
+    uint16_t repeatTicks[BUTTON_COUNT];     // Ticks to the next repeat of a held button
+    uint8_t repeatInterval[BUTTON_COUNT];
+    uint8_t repeatCount[BUTTON_COUNT];
+
+    ButtonEvent events[BUTTON_EVENT_QUEUE];
+    volatile uint8_t eventHead;        // Written by the tick
+    volatile uint8_t eventTail;        // Written by poll()
+};
+
+#endif // BUTTONINPUT_H
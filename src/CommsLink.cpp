@@ -0,0 +1,233 @@
+#include "CommsLink.h"
+#include "Crc16.h"
+
+CommsLink::CommsLink() {
+    queued = 0;
+    nextSeq = 0;
+    inFlight = false;
+    retries = 0;
+    sentAt = 0;
+    rxLength = 0;
+    command.type = 0;
+    command.value = 0;
+    commandSeq = 0;
+    commandWaiting = false;
+    lastCommand.type = 0;
+    lastCommand.value = 0;
+    lastCommandSeq = 0;
+    lastCommandAt = 0;
+    anyCommand = false;
+    eventsSent = 0;
+    eventsAcked = 0;
+    resends = 0;
+    dropped = 0;
+    badFrames = 0;
+    commands = 0;
+    repeatedCommands = 0;
+    refusedCommands = 0;
+    worstAckMicros = 0;
+    sentAtMicros = 0;
+}
+
+void CommsLink::send(CommsEvent& event) {
+    // Only the latest energy matters; replace one that hasn't gone out yet
+    uint8_t first = inFlight ? 1 : 0;
+    if (event.type == COMMS_FRAME_ENERGY && queued > first && queue[queued - 1].type == COMMS_FRAME_ENERGY) {
+        event.seq = queue[queued - 1].seq;
+        queue[queued - 1] = event;
+        return;
+    }
+
+    if (queued == COMMS_QUEUE_SIZE) {
+        Serial.println(F("Comms queue full, event dropped"));
+        dropped++;
+        return;
+    }
+    event.seq = nextSeq++;
+    queue[queued++] = event;
+}
+
+void CommsLink::poll(unsigned long now) {
+    if (inFlight) {
+        if (now - sentAt < COMMS_ACK_TIMEOUT) {
+            return;
+        }
+        if (retries >= COMMS_MAX_RETRIES) {
+            dropped++;
+            dequeue();
+        } else {
+            retries++;
+            resends++;
+            sentAt = now;
+            transmit(queue[0]);
+            return;
+        }
+    }
+    if (queued > 0) {
+        inFlight = true;
+        retries = 0;
+        sentAt = now;
+        sentAtMicros = micros();
+        eventsSent++;
+        transmit(queue[0]);
+    }
+}
+
+void CommsLink::transmit(const CommsEvent& event) {
+    uint8_t frame[COMMS_FRAME_OVERHEAD + COMMS_EVENT_PAYLOAD];
+    frame[0] = COMMS_FRAME_START;
+    frame[1] = event.type;
+    frame[2] = event.seq;
+    frame[3] = COMMS_EVENT_PAYLOAD;
+    uint8_t* payload = frame + 4;
+    memcpy(payload, event.uid, COMMS_UID_LENGTH);
+    payload[7] = event.trait;
+    payload[8] = event.energy;
+    payload[9] = event.stations;
+    payload[10] = event.stations >> 8;
+    payload[11] = event.micros;
+    payload[12] = event.micros >> 8;
+    payload[13] = event.micros >> 16;
+    payload[14] = event.micros >> 24;
+
+    uint16_t crc = crc16Update(CRC16_INIT, frame + 1, 3 + COMMS_EVENT_PAYLOAD);
+    frame[sizeof(frame) - 2] = crc >> 8;
+    frame[sizeof(frame) - 1] = crc;
+    Serial.write(frame, sizeof(frame));
+}
+
+void CommsLink::dequeue() {
+    inFlight = false;
+    queued--;
+    memmove(&queue[0], &queue[1], queued * sizeof(CommsEvent));
+}
+
+bool CommsLink::receive(uint8_t data) {
+    if (rxLength == 0 && data != COMMS_FRAME_START) {
+        return false;
+    }
+    rxFrame[rxLength++] = data;
+    // A payload longer than any frame we take means the stream is out of step; start over at the next 0xA5
+    if (rxLength == 4 && data > COMMS_COMMAND_PAYLOAD) {
+        badFrames++;
+        rxLength = 0;
+        return true;
+    }
+    if (rxLength < 4 || rxLength < COMMS_FRAME_OVERHEAD + rxFrame[3]) {
+        return true;
+    }
+    handleFrame();
+    rxLength = 0;
+    return true;
+}
+
+void CommsLink::handleFrame() {
+    uint8_t length = rxFrame[3];
+    uint16_t crc = crc16Update(CRC16_INIT, rxFrame + 1, 3 + length);
+    if (rxFrame[4 + length] != (uint8_t)(crc >> 8) || rxFrame[5 + length] != (uint8_t)crc) {
+        badFrames++;
+        return;
+    }
+    uint8_t type = rxFrame[1];
+    uint8_t seq = rxFrame[2];
+
+    if (type == COMMS_FRAME_ACK) {
+        // An ACK for anything but the event in flight is a late duplicate
+        if (inFlight && seq == queue[0].seq) {
+            unsigned long ackMicros = micros() - sentAtMicros;
+            if (ackMicros > worstAckMicros) {
+                worstAckMicros = ackMicros;
+            }
+            eventsAcked++;
+            dequeue();
+        }
+        return;
+    }
+
+    if (type < COMMS_CMD_SET_ENERGY || type > COMMS_CMD_SET_TRAIT || length != COMMS_COMMAND_PAYLOAD) {
+        badFrames++;
+        return;
+    }
+    // Our ACK was lost and the controller sent it again: it already ran
+    unsigned long now = millis();
+    if (anyCommand && seq == lastCommandSeq && type == lastCommand.type && rxFrame[4] == lastCommand.value
+        && now - lastCommandAt < COMMS_REPEAT_WINDOW) {
+        lastCommandAt = now;
+        repeatedCommands++;
+        sendAck(seq);
+        return;
+    }
+    // Not acknowledged, so the controller resends it once the waiting one has run
+    if (commandWaiting) {
+        return;
+    }
+    command.type = type;
+    command.value = rxFrame[4];
+    commandSeq = seq;
+    commandWaiting = true;
+}
+
+bool CommsLink::takeCommand(CommsCommand& waiting) {
+    if (!commandWaiting) {
+        return false;
+    }
+    waiting = command;
+    return true;
+}
+
+void CommsLink::finishCommand(bool ran) {
+    if (!commandWaiting) {
+        return;
+    }
+    commandWaiting = false;
+    if (!ran) {
+        refusedCommands++;
+        return;
+    }
+    lastCommand = command;
+    lastCommandSeq = commandSeq;
+    lastCommandAt = millis();
+    anyCommand = true;
+    commands++;
+    sendAck(commandSeq);
+}
+
+void CommsLink::sendAck(uint8_t seq) {
+    uint8_t frame[COMMS_FRAME_OVERHEAD] = { COMMS_FRAME_START, COMMS_FRAME_ACK, seq, 0, 0, 0 };
+    uint16_t crc = crc16Update(CRC16_INIT, frame + 1, 3);
+    frame[4] = crc >> 8;
+    frame[5] = crc;
+    Serial.write(frame, sizeof(frame));
+}
+
+void CommsLink::printStats() {
+    Serial.print(F("Comms: sent "));
+    Serial.print(eventsSent);
+    Serial.print(F(", acked "));
+    Serial.print(eventsAcked);
+    Serial.print(F(", resent "));
+    Serial.print(resends);
+    Serial.print(F(", dropped "));
+    Serial.print(dropped);
+    Serial.print(F(", bad frames "));
+    Serial.print(badFrames);
+    Serial.print(F(", commands "));
+    Serial.print(commands);
+    Serial.print(F(" ("));
+    Serial.print(repeatedCommands);
+    Serial.print(F(" repeated, "));
+    Serial.print(refusedCommands);
+    Serial.print(F(" refused)"));
+    Serial.print(F(", worst ack "));
+    Serial.print(worstAckMicros);
+    Serial.println(F("us"));
+    eventsSent = 0;
+    eventsAcked = 0;
+    resends = 0;
+    dropped = 0;
+    badFrames = 0;
+    commands = 0;
+    repeatedCommands = 0;
+    refusedCommands = 0;
+    worstAckMicros = 0;
+}
@@ -0,0 +1,115 @@
+#ifndef COMMSLINK_H
+#define COMMSLINK_H
+
+#include <Arduino.h>
+
+// Framed orb events to an external controller over the serial port, alongside the comms pins,
+// and commands from it.
+//   0xA5 | type | seq | payload length | payload | CRC-16 (big endian)
+// The CRC (see Crc16.h) covers type through payload. Each side answers the other's frames with
+// an ACK frame carrying their seq and no payload; unacknowledged frames are resent, so each side
+// drops repeats by seq. Log text on the same port is plain ASCII and never contains 0xA5.
+#define COMMS_FRAME_START 0xA5
+#define COMMS_FRAME_CONNECT 0x01
+#define COMMS_FRAME_DISCONNECT 0x02
+#define COMMS_FRAME_ENERGY 0x03
+#define COMMS_FRAME_TRAIT 0x04
+#define COMMS_FRAME_ACK 0x80
+#define COMMS_FRAME_OVERHEAD 6      // Start, type, seq, length, CRC
+
+// Commands from the controller, one payload byte each. They run from loop() and are acknowledged
+// only once they have: a command with no orb on the dock, or one the orb couldn't take (a failed
+// write, an unknown trait), gets no ACK and the controller keeps resending it. A frame matching
+// the last command's seq, type and value within COMMS_REPEAT_WINDOW of it is a resend after a
+// lost ACK: acknowledged again but not run again.
+// Anything else is a new command, so a restarted controller or a wrapped seq is never ignored;
+// the controller waits out the window before sending the same command under the same seq.
+#define COMMS_CMD_SET_ENERGY 0x10   // Energy
+#define COMMS_CMD_ADD_ENERGY 0x11   // int8_t change, stopping at empty and full
+#define COMMS_CMD_SET_TRAIT 0x12    // TraitId
+#define COMMS_COMMAND_PAYLOAD 1
+#define COMMS_REPEAT_WINDOW 250     // ms since the last copy of a command for a match to be a resend
+
+// Event payload, multi-byte fields little endian:
+//   UID (7) | trait | energy | visited stations (uint16, bit n = StationId n) | micros() at the event (uint32)
+#define COMMS_UID_LENGTH 7
+#define COMMS_EVENT_PAYLOAD 15
+
+#define COMMS_ACK_TIMEOUT 20        // ms; an event frame takes under 2ms at 115200
+#define COMMS_MAX_RETRIES 5         // Then the event is dropped and the next one sent
+#define COMMS_QUEUE_SIZE 4
+
+struct CommsCommand {
+    uint8_t type;
+    uint8_t value;
+};
+
+struct CommsEvent {
+    uint8_t type;
+    uint8_t seq;
+    uint8_t uid[COMMS_UID_LENGTH];
+    uint8_t trait;
+    uint8_t energy;
+    uint16_t stations;
+    uint32_t micros;
+};
+
+class CommsLink {
+public:
+    CommsLink();
+
+    // Queues an event, numbering it. An energy change still waiting to be sent is replaced
+    // by a newer one rather than queued behind it.
+    void send(CommsEvent& event);
+    // Sends the next event, or resends one the controller hasn't acknowledged
+    void poll(unsigned long now);
+    // Feeds a received byte to the frame parser; returns false if it isn't part of a frame
+    bool receive(uint8_t data);
+    // Takes the command waiting to run, if any; finishCommand() must follow
+    bool takeCommand(CommsCommand& command);
+    // Acknowledges the taken command if it ran, or forgets it so its resend is taken as new
+    void finishCommand(bool ran);
+
+    // Prints and resets the link statistics
+    void printStats();
+
+private:
+    void transmit(const CommsEvent& event);
+    void sendAck(uint8_t seq);
+    void dequeue();
+    void handleFrame();
+
+    CommsEvent queue[COMMS_QUEUE_SIZE];  // queue[0] is in flight once sent
+    uint8_t queued;
+    uint8_t nextSeq;
+    bool inFlight;
+    uint8_t retries;
+    unsigned long sentAt;
+
+    // Frame parser
+    uint8_t rxFrame[COMMS_FRAME_OVERHEAD + COMMS_COMMAND_PAYLOAD];
+    uint8_t rxLength;
+
+    // Commands: one waits at a time; the controller resends until it has run
+    CommsCommand command;
+    uint8_t commandSeq;
+    bool commandWaiting;
+    CommsCommand lastCommand;
+    uint8_t lastCommandSeq;
+    unsigned long lastCommandAt;    // millis() the last copy of it arrived
+    bool anyCommand;                // lastCommand is valid
+
+    // Statistics
+    uint16_t eventsSent;
+    uint16_t eventsAcked;
+    uint16_t resends;
+    uint16_t dropped;
+    uint16_t badFrames;
+    uint16_t commands;
+    uint16_t repeatedCommands;
+    uint16_t refusedCommands;
+    unsigned long worstAckMicros;
+    unsigned long sentAtMicros;
+};
+
+#endif // COMMSLINK_H
@@ -0,0 +1,25 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <Arduino.h>
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), used to protect binary data sent over serial.
+// Kept bitwise rather than table driven so it costs no flash or RAM for a lookup table.
+#define CRC16_INIT 0xFFFF
+
+inline uint16_t crc16Update(uint16_t crc, uint8_t data) {
+    crc ^= (uint16_t)data << 8;
+    for (uint8_t i = 0; i < 8; i++) {
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+    return crc;
+}
+
+inline uint16_t crc16Update(uint16_t crc, const uint8_t* data, uint16_t length) {
+    while (length--) {
+        crc = crc16Update(crc, *data++);
+    }
+    return crc;
+}
+
+#endif
@@ -0,0 +1,43 @@
+#include "LedCanvas.h"
+
+LedCanvas::LedCanvas() {
+    pixels = nullptr;
+    size = 0;
+    segmentCount = 0;
+}
+
+void LedCanvas::begin(CRGB* canvasPixels) {
+    pixels = canvasPixels;
+    size = 0;
+    segmentCount = 0;
+}
+
+CRGB* LedCanvas::addSegment(uint16_t count, uint8_t output, bool reversed) {
+    if (segmentCount >= LED_CANVAS_MAX_SEGMENTS) {
+        Serial.println(F("LED canvas: too many segments"));
+        return nullptr;
+    }
+    Segment& segment = segments[segmentCount++];
+    segment.start = size;
+    segment.count = count;
+    segment.output = output;
+    segment.reversed = reversed;
+    size += count;
+    return pixels + segment.start;
+}
+
+void LedCanvas::flipReversed(uint8_t outputs) {
+    for (uint8_t i = 0; i < segmentCount; i++) {
+        Segment& segment = segments[i];
+        if (!segment.reversed || !(segment.output & outputs)) {
+            continue;
+        }
+        CRGB* front = pixels + segment.start;
+        CRGB* back = front + segment.count - 1;
+        while (front < back) {
+            CRGB swap = *front;
+            *front++ = *back;
+            *back-- = swap;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef LEDCANVAS_H
+#define LEDCANVAS_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+#define LED_CANVAS_MAX_SEGMENTS 4
+#define LED_SEGMENT_FORWARD false
+#define LED_SEGMENT_REVERSED true   // Wired to run from the far end
+
+// One logical strip over a dock's pixel buffer, made of segments that each map onto a physical
+// strip. A pattern renders the whole canvas once per frame in logical order, instead of each
+// strip separately or reversing by hand. Reversed segments are flipped into physical order only
+// around the latch, so patterns always see their own frame.
+class LedCanvas {
+public:
+    LedCanvas();
+
+    // Uses pixels for the canvas; segments are carved from it in order
+    void begin(CRGB* pixels);
+    // Adds the next count pixels as a segment latched with output (LED_OUTPUT_*); returns them
+    // for registering a controller, or nullptr if there are too many segments
+    CRGB* addSegment(uint16_t count, uint8_t output, bool reversed = LED_SEGMENT_FORWARD);
+
+    CRGB* getPixels() const { return pixels; }
+    uint16_t getSize() const { return size; }
+    uint8_t getSegmentCount() const { return segmentCount; }
+
+    // Bracket a latch of the given outputs: puts their reversed segments into physical order, then back
+    void beginOutput(uint8_t outputs) { flipReversed(outputs); }
+    void endOutput(uint8_t outputs) { flipReversed(outputs); }
+
+private:
+    struct Segment {
+        uint16_t start;
+        uint16_t count;
+        uint8_t output;
+        bool reversed;
+    };
+
+    void flipReversed(uint8_t outputs);
+
+    CRGB* pixels;
+    uint16_t size;
+    Segment segments[LED_CANVAS_MAX_SEGMENTS];
+    uint8_t segmentCount;
+};
+
+#endif // LEDCANVAS_H
@@ -0,0 +1,36 @@
+#include "LedCrossfade.h"
+
+LedCrossfade::LedCrossfade() {
+    frames = 0;
+    framesLeft = 0;
+    fromBrightness = 0;
+}
+
+void LedCrossfade::start(uint8_t fadeFrames, uint8_t brightness) {
+    frames = fadeFrames;
+    framesLeft = fadeFrames;
+    fromBrightness = brightness;
+}
+
+void LedCrossfade::apply(CRGB* output, const CRGB* canvas, uint16_t count) {
+    if (framesLeft == 0) {
+        memcpy(output, canvas, count * sizeof(CRGB));
+        return;
+    }
+
+    // Covering 1/framesLeft of the remaining distance each frame lands on the canvas exactly
+    // on the last frame, for a linear fade while the canvas holds still
+    uint8_t amount = framesLeft == 1 ? 255 : 256 / framesLeft;
+    for (uint16_t i = 0; i < count; i++) {
+        nblend(output[i], canvas[i], amount);
+    }
+    framesLeft--;
+}
+
+uint8_t LedCrossfade::getBrightness(uint8_t target) const {
+    if (framesLeft == 0) {
+        return target;
+    }
+    uint8_t done = frames - framesLeft;
+    return fromBrightness + ((int16_t)target - fromBrightness) * (int32_t)done / frames;
+}
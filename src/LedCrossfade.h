@@ -0,0 +1,31 @@
+#ifndef LEDCROSSFADE_H
+#define LEDCROSSFADE_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+// Integer crossfade between LED patterns. A pattern renders into its own canvas, and the output
+// buffer (what gets latched) follows it: copied when settled, or blended a step closer each frame
+// during a fade, so the outgoing frame eases into the incoming one over a fixed number of frames.
+// Brightness moves from the outgoing pattern's to the incoming one's alongside, and is still only
+// applied when latching (LedEngine), never to the buffers.
+class LedCrossfade {
+public:
+    LedCrossfade();
+
+    // Starts fading from the current output, shown at fromBrightness; 0 frames switches at once
+    void start(uint8_t frames, uint8_t fromBrightness);
+    bool isActive() const { return framesLeft > 0; }
+
+    // Brings output one frame closer to canvas
+    void apply(CRGB* output, const CRGB* canvas, uint16_t count);
+    // Brightness to latch this frame with, on the way to the incoming pattern's
+    uint8_t getBrightness(uint8_t target) const;
+
+private:
+    uint8_t frames;
+    uint8_t framesLeft;
+    uint8_t fromBrightness;
+};
+
+#endif // LEDCROSSFADE_H
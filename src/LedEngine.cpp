@@ -0,0 +1,42 @@
+#include "LedEngine.h"
+
+LedEngine::LedEngine() {
+    controllerCount = 0;
+}
+
+bool LedEngine::addOutput(uint8_t output, CLEDController& controller, uint8_t brightness) {
+    if (controllerCount >= LED_ENGINE_MAX_CONTROLLERS) {
+        Serial.println(F("LED engine: too many controllers"));
+        return false;
+    }
+    controllers[controllerCount].controller = &controller;
+    controllers[controllerCount].output = output;
+    controllers[controllerCount].brightness = brightness;
+    controllerCount++;
+    return true;
+}
+
+void LedEngine::setBrightness(uint8_t outputs, uint8_t brightness) {
+    for (uint8_t i = 0; i < controllerCount; i++) {
+        if (controllers[i].output & outputs) {
+            controllers[i].brightness = brightness;
+        }
+    }
+}
+
+uint8_t LedEngine::getBrightness(uint8_t output) const {
+    for (uint8_t i = 0; i < controllerCount; i++) {
+        if (controllers[i].output & output) {
+            return controllers[i].brightness;
+        }
+    }
+    return 0;
+}
+
+void LedEngine::show(uint8_t outputs) {
+    for (uint8_t i = 0; i < controllerCount; i++) {
+        if (controllers[i].output & outputs) {
+            controllers[i].controller->showLeds(controllers[i].brightness);
+        }
+    }
+}
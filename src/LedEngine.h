@@ -0,0 +1,37 @@
+#ifndef LEDENGINE_H
+#define LEDENGINE_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+#define LED_ENGINE_MAX_CONTROLLERS 4
+
+// Single driver for every LED output on a dock: the ring and any station strips are FastLED
+// controllers over CRGB buffers. Brightness is kept per output and applied while latching,
+// so pixel buffers are never rescaled. FastLED.show() is never used, since it would latch
+// every controller at one global brightness.
+class LedEngine {
+public:
+    LedEngine();
+
+    // Registers a controller under an output (LED_OUTPUT_*); several controllers may share one
+    bool addOutput(uint8_t output, CLEDController& controller, uint8_t brightness = 255);
+
+    void setBrightness(uint8_t outputs, uint8_t brightness);
+    uint8_t getBrightness(uint8_t output) const;
+
+    // Latches every controller belonging to the given outputs
+    void show(uint8_t outputs);
+
+private:
+    struct Controller {
+        CLEDController* controller;
+        uint8_t output;
+        uint8_t brightness;
+    };
+
+    Controller controllers[LED_ENGINE_MAX_CONTROLLERS];
+    uint8_t controllerCount;
+};
+
+#endif // LEDENGINE_H
@@ -0,0 +1,100 @@
+#include "LedFrameScheduler.h"
+
+LedFrameScheduler::LedFrameScheduler(uint8_t targetFps) {
+    setTargetFps(targetFps);
+    nextFrame = 0;
+    dirtyOutputs = 0;
+    renderStart = 0;
+    latchStart = 0;
+    frameRenderTime = 0;
+    resetStats();
+}
+
+void LedFrameScheduler::setTargetFps(uint8_t fps) {
+    targetFps = max(fps, (uint8_t)1);
+    framePeriod = 1000000UL / targetFps;
+}
+
+bool LedFrameScheduler::frameDue(unsigned long nowMicros) {
+    long late = (long)(nowMicros - nextFrame);
+    if (late < 0) {
+        return false;
+    }
+    // Skip the slots we missed instead of rendering them back to back
+    if ((unsigned long)late >= framePeriod) {
+        unsigned long missed = late / framePeriod;
+        droppedFrames += missed;
+        nextFrame += missed * framePeriod;
+    }
+    nextFrame += framePeriod;
+    frames++;
+    return true;
+}
+
+void LedFrameScheduler::beginRender() {
+    renderStart = micros();
+}
+
+void LedFrameScheduler::endRender() {
+    frameRenderTime = micros() - renderStart;
+    renderTotal += frameRenderTime;
+    renderMax = max(renderMax, (uint16_t)min(frameRenderTime, 0xFFFFUL));
+    if (frameRenderTime > framePeriod) {
+        overruns++;
+    }
+}
+
+void LedFrameScheduler::beginLatch() {
+    latchStart = micros();
+}
+
+void LedFrameScheduler::endLatch() {
+    unsigned long latchTime = micros() - latchStart;
+    latchTotal += latchTime;
+    latchMax = max(latchMax, (uint16_t)min(latchTime, 0xFFFFUL));
+    latches++;
+    dirtyOutputs = 0;
+    // A frame whose render and latch together blow the budget pushes the next one late
+    if (frameRenderTime <= framePeriod && frameRenderTime + latchTime > framePeriod) {
+        overruns++;
+    }
+}
+
+void LedFrameScheduler::printStats() {
+    Serial.print(F("LED frames: target "));
+    Serial.print(targetFps);
+    Serial.print(F(" fps, "));
+    Serial.print(frames);
+    Serial.print(F(" frames in "));
+    Serial.print(millis() - statsStart);
+    Serial.print(F(" ms, "));
+    Serial.print(latches);
+    Serial.print(F(" latched, "));
+    Serial.print(droppedFrames);
+    Serial.print(F(" dropped, "));
+    Serial.print(overruns);
+    Serial.println(F(" overruns"));
+
+    Serial.print(F("  render avg/max us: "));
+    Serial.print(frames ? renderTotal / frames : 0);
+    Serial.print(F("/"));
+    Serial.print(renderMax);
+    Serial.print(F(", latch avg/max us: "));
+    Serial.print(latches ? latchTotal / latches : 0);
+    Serial.print(F("/"));
+    Serial.println(latchMax);
+
+    resetStats();
+}
+
+void LedFrameScheduler::resetStats() {
+    statsStart = millis();
+    frames = 0;
+    latches = 0;
+    droppedFrames = 0;
+    overruns = 0;
+    renderTotal = 0;
+    latchTotal = 0;
+    renderMax = 0;
+    latchMax = 0;
+}
@@ -0,0 +1,58 @@
+#ifndef LEDFRAMESCHEDULER_H
+#define LEDFRAMESCHEDULER_H
+
+#include <Arduino.h>
+
+// LED outputs a frame can touch; a dock passes the dirty ones to showFrame()
+#define LED_OUTPUT_RING  0x01
+#define LED_OUTPUT_STRIP 0x02
+
+// Fixed-timestep frame clock for all LED outputs. A frame is rendered once per slot at the
+// target rate, and outputs are only latched when the frame actually changed them.
+class LedFrameScheduler {
+public:
+    LedFrameScheduler(uint8_t targetFps);
+
+    void setTargetFps(uint8_t fps);
+    uint8_t getTargetFps() const { return targetFps; }
+
+    // True once per frame slot; slots that passed while loop() was busy count as dropped
+    bool frameDue(unsigned long nowMicros);
+
+    // Marks outputs as changed, from a render or from an event handler between frames
+    void markDirty(uint8_t outputs) { dirtyOutputs |= outputs; }
+    uint8_t getDirtyOutputs() const { return dirtyOutputs; }
+
+    // Timing for the current frame; endLatch() clears the dirty outputs
+    void beginRender();
+    void endRender();
+    void beginLatch();
+    void endLatch();
+
+    // Prints and resets the frame budget statistics
+    void printStats();
+
+private:
+    void resetStats();
+
+    uint8_t targetFps;
+    unsigned long framePeriod;      // us
+    unsigned long nextFrame;        // us
+    uint8_t dirtyOutputs;
+    unsigned long renderStart;
+    unsigned long latchStart;
+    unsigned long frameRenderTime;  // us spent rendering the current frame
+
+    // Frame budget statistics since the last report
+    unsigned long statsStart;
+    uint32_t frames;                // 32 bits: a dock can run for days between reports
+    uint32_t latches;
+    uint32_t droppedFrames;
+    uint32_t overruns;
+    unsigned long renderTotal;
+    unsigned long latchTotal;
+    uint16_t renderMax;
+    uint16_t latchMax;
+};
+
+#endif // LEDFRAMESCHEDULER_H
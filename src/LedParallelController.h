@@ -0,0 +1,114 @@
+#ifndef LEDPARALLELCONTROLLER_H
+#define LEDPARALLELCONTROLLER_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+// WS2812 output for several strips on one AVR port, clocked out together in a single bit-banged
+// pass, so latching N equal strips takes as long as one of them rather than their sum.
+//
+// Pin assignment: every lane must be on LED_PARALLEL_PORT, PORTB, which is Nano pins D8-D13
+// (PB0-PB5; D13 also drives the onboard LED). Masks are PORTB bits, e.g. _BV(0) for D8.
+// The other PORTB pins keep their state, but nothing may write PORTB from an interrupt.
+// Interrupts are held off for one byte (10us) at a time rather than the whole latch.
+//
+// Lanes read the buffer back to back (lane i starts at leds + i * count), as FastLED's own
+// multi-lane controllers do. Strips that always show the same thing can instead share one lane
+// with several bits in its mask: they mirror a single buffer.
+#define LED_PARALLEL_PORT PORTB
+#define LED_PARALLEL_DDR DDRB
+
+#if F_CPU != 16000000L
+#error "LedParallelController timing assumes a 16MHz clock"
+#endif
+
+// One WS2812 bit on every lane, 20 cycles (1.25us) at 16MHz: all lanes high, the lanes sending
+// a 0 drop after 6 cycles (375ns), the rest after 12 (750ns), then low for the remainder
+#define LED_PARALLEL_BIT(data)                                          \
+    "out %[port], %[hi]\n\t"                                            \
+    "nop\n\t" "nop\n\t" "nop\n\t" "nop\n\t" "nop\n\t"                   \
+    "out %[port], " data "\n\t"                                         \
+    "nop\n\t" "nop\n\t" "nop\n\t" "nop\n\t" "nop\n\t"                   \
+    "out %[port], %[lo]\n\t"                                            \
+    "nop\n\t" "nop\n\t" "nop\n\t" "nop\n\t" "nop\n\t" "nop\n\t" "nop\n\t"
+
+template <uint8_t LANES>
+class LedParallelController : public CPixelLEDController<GRB, LANES, 0xFF> {
+public:
+    // laneMasks[i] is the PORTB bits lane i drives
+    explicit LedParallelController(const uint8_t* laneMasks) {
+        allLanes = 0;
+        for (uint8_t lane = 0; lane < LANES; lane++) {
+            masks[lane] = laneMasks[lane];
+            allLanes |= laneMasks[lane];
+        }
+    }
+
+    virtual void init() {
+        LED_PARALLEL_PORT &= ~allLanes;
+        LED_PARALLEL_DDR |= allLanes;
+    }
+
+protected:
+    virtual void showPixels(PixelController<GRB, LANES, 0xFF>& pixels) {
+        uint8_t lo = LED_PARALLEL_PORT & ~allLanes;
+        uint8_t hi = lo | allLanes;
+        uint8_t channels[LANES];
+
+        while (pixels.has(1)) {
+            for (uint8_t lane = 0; lane < LANES; lane++) {
+                channels[lane] = pixels.loadAndScale0(lane);
+            }
+            writeByte(channels, lo, hi);
+            for (uint8_t lane = 0; lane < LANES; lane++) {
+                channels[lane] = pixels.loadAndScale1(lane);
+            }
+            writeByte(channels, lo, hi);
+            for (uint8_t lane = 0; lane < LANES; lane++) {
+                channels[lane] = pixels.loadAndScale2(lane);
+            }
+            writeByte(channels, lo, hi);
+            pixels.stepDithering();
+            pixels.advanceData();
+        }
+    }
+
+private:
+    uint8_t masks[LANES];
+    uint8_t allLanes;
+
+    // Sends one byte per lane, MSB first. The port values for all 8 bits are worked out first,
+    // with interrupts on; the strips hold through the longer low time in between bytes.
+    void writeByte(const uint8_t* channels, uint8_t lo, uint8_t hi) {
+        uint8_t bits[8];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            uint8_t value = lo;
+            for (uint8_t lane = 0; lane < LANES; lane++) {
+                if (channels[lane] & (0x80 >> bit)) {
+                    value |= masks[lane];
+                }
+            }
+            bits[bit] = value;
+        }
+
+        uint8_t oldSREG = SREG;
+        cli();
+        asm volatile(
+            LED_PARALLEL_BIT("%[b0]")
+            LED_PARALLEL_BIT("%[b1]")
+            LED_PARALLEL_BIT("%[b2]")
+            LED_PARALLEL_BIT("%[b3]")
+            LED_PARALLEL_BIT("%[b4]")
+            LED_PARALLEL_BIT("%[b5]")
+            LED_PARALLEL_BIT("%[b6]")
+            LED_PARALLEL_BIT("%[b7]")
+            :
+            : [port] "I" (_SFR_IO_ADDR(LED_PARALLEL_PORT)), [hi] "r" (hi), [lo] "r" (lo),
+              [b0] "r" (bits[0]), [b1] "r" (bits[1]), [b2] "r" (bits[2]), [b3] "r" (bits[3]),
+              [b4] "r" (bits[4]), [b5] "r" (bits[5]), [b6] "r" (bits[6]), [b7] "r" (bits[7])
+        );
+        SREG = oldSREG;
+    }
+};
+
+#endif // LEDPARALLELCONTROLLER_H
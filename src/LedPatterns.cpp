@@ -0,0 +1,438 @@
+#include "LedPatterns.h"
+#include "LedTables.h"
+#include "TraitPalette.h"
+
+/********************** HELPERS *****************************/
+
+// Advances a phase accumulator that bounces between 0 and range by steps * rate, returning its position
+static uint16_t bouncePhase(uint16_t& phase, uint16_t steps, uint8_t rate, uint16_t range) {
+    uint16_t period = 2 * range;
+    phase = (phase + (uint32_t)steps * rate % period) % period;
+    return phase <= range ? phase : period - phase;
+}
+
+// Exact (a * b) / 255 for 8-bit a and b without a division
+static uint8_t scale255(uint8_t a, uint8_t b) {
+    uint16_t product = (uint16_t)a * b;
+    return (product + 1 + (product >> 8)) >> 8;
+}
+
+// Dims a color by a certain intensity (0-255)
+static CRGB dimColor(CRGB color, uint8_t intensity) {
+    color.r = (color.r * intensity) >> 8;
+    color.g = (color.g * intensity) >> 8;
+    color.b = (color.b * intensity) >> 8;
+    return color;
+}
+
+/********************** RING PATTERNS *****************************/
+
+// Rainbow cycle along whole strip
+static uint8_t renderRainbow(LedPatternFrame& frame, LedPatternState& state) {
+    RainbowState& s = state.rainbow;
+    s.firstPixelHue += frame.steps * 256;  // Wraps with the hue
+    uint16_t pixelHue = s.firstPixelHue;
+    uint16_t hueStep = 65536L / frame.count;
+    for (uint16_t i = 0; i < frame.count; i++) {
+        frame.leds[i] = rainbowColor(pixelHue);
+        pixelHue += hueStep;
+    }
+    return LED_FRAME_CHANGED;
+}
+
+// Rotates a weakening dot around the ring using the trait color.
+// The fade table covers half the ring, so this expects 2 * CHASE_FADE_STEPS pixels.
+static uint8_t renderTraitChase(LedPatternFrame& frame, TraitChaseState& s) {
+    const uint16_t HUE_RANGE = 100; // Maximum hue shift in either direction
+    const uint8_t MIN_INTENSITY = 30;
+
+    // Global intensity pulses between MIN_INTENSITY and 255, 9 per step
+    uint8_t globalIntensity = MIN_INTENSITY + bouncePhase(s.globalPhase, frame.steps, 9, 255 - MIN_INTENSITY);
+    // Hue offset swings between 0 and HUE_RANGE, 1 per step
+    uint16_t hueOffset = bouncePhase(s.huePhase, frame.steps, 1, HUE_RANGE);
+    s.currentPixel = (s.currentPixel + frame.steps) % frame.count;
+
+    // Hue shift of up to 30 degrees from the trait palette: 205/256 ~= TRAIT_PALETTE_SHIFT(30) / HUE_RANGE
+    CRGB traitColor = ColorFromPalette(*frame.palette, TRAIT_PALETTE_CENTER + (((uint16_t)hueOffset * 205) >> 8));
+
+    // Set both bright dots, then the pixels between them with the fade curve
+    for (int i = 0; i < CHASE_FADE_STEPS; i++) {
+        uint8_t adjustedIntensity = scale255(pgm_read_byte(&CHASE_FADE[i]), globalIntensity);
+        if (i > 0 && adjustedIntensity == 0) {
+            continue;
+        }
+        CRGB color = dimColor(traitColor, adjustedIntensity);
+
+        uint16_t pixel1 = s.currentPixel + i;
+        if (pixel1 >= frame.count) pixel1 -= frame.count;
+        uint16_t pixel2 = i == 0 ? s.currentPixel + frame.count / 2 : s.currentPixel + frame.count - i;
+        if (pixel2 >= frame.count) pixel2 -= frame.count;
+        frame.leds[pixel1] = color;
+        frame.leds[pixel2] = color;
+    }
+    return LED_FRAME_CHANGED;
+}
+
+// Slowly pulse dim red up and down
+static uint8_t renderNoEnergyPulse(LedPatternFrame& frame, uint16_t& phase) {
+    uint8_t intensity = bouncePhase(phase, frame.steps, 1, 255);
+    fill_solid(frame.leds, frame.count, CRGB(intensity, 0, 0));
+    return LED_FRAME_CHANGED;
+}
+
+static uint8_t renderNoEnergy(LedPatternFrame& frame, LedPatternState& state) {
+    return renderNoEnergyPulse(frame, state.phase.phase);
+}
+
+// The trait chase, or the no-energy pulse once the orb is drained
+static uint8_t renderOrbConnected(LedPatternFrame& frame, LedPatternState& state) {
+    if (frame.energy == 0) {
+        return renderNoEnergyPulse(frame, state.orbConnected.pulsePhase);
+    }
+    return renderTraitChase(frame, state.orbConnected.chase);
+}
+
+// One fast fade from full to dim while the hue rotates, then back to the orb's pattern
+static uint8_t renderFlash(LedPatternFrame& frame, LedPatternState& state) {
+    FlashState& s = state.flash;
+    const uint8_t FADE_RATE = 12;
+    const uint8_t MIN_INTENSITY = 30;
+    const uint16_t FADE_STEPS = (255 - MIN_INTENSITY + FADE_RATE - 1) / FADE_RATE;
+
+    s.elapsedSteps = min((uint32_t)s.elapsedSteps + frame.steps, (uint32_t)FADE_STEPS + 1);
+    if (s.elapsedSteps > FADE_STEPS) {
+        return LED_FRAME_DONE;
+    }
+    uint8_t intensity = max(255 - FADE_RATE * s.elapsedSteps, (int)MIN_INTENSITY);
+
+    // Rotate hue offset in opposite direction, 8 degrees per step (angles are 65536 to the turn)
+    s.hueOffset -= frame.steps * (uint16_t)(8 * 65536L / 360);
+
+    // Fill strip with colors swinging +/- 30 degrees around the trait color: 5/8 of +/-128 = TRAIT_PALETTE_SHIFT(30)
+    uint16_t pixelHue = s.hueOffset;
+    uint16_t hueStep = 65536L / frame.count;
+    for (uint16_t i = 0; i < frame.count; i++) {
+        int8_t hueShift = ((sin16(pixelHue) >> 8) * 5) >> 3;
+        frame.leds[i] = ColorFromPalette(*frame.palette, TRAIT_PALETTE_CENTER + hueShift, intensity);
+        pixelHue += hueStep;
+    }
+    return LED_FRAME_CHANGED;
+}
+
+// Slow fade between blue and red
+static uint8_t renderError(LedPatternFrame& frame, LedPatternState& state) {
+    uint8_t r = bouncePhase(state.phase.phase, frame.steps, 1, 255);
+    fill_solid(frame.leds, frame.count, CRGB(r, 0, 255 - r));
+    return LED_FRAME_CHANGED;
+}
+
+// Slow, mostly dark breathing glow for low power idle
+static uint8_t renderBreathe(LedPatternFrame& frame, LedPatternState& state) {
+    uint8_t phase = state.phase.phase += frame.steps;  // Wraps with the cycle
+
+    // Squaring a triangle wave keeps the ring near dark for most of the cycle
+    uint8_t level = phase < 128 ? phase * 2 : (255 - phase) * 2;
+    level = ((uint16_t)level * level) >> 8;
+    fill_solid(frame.leds, frame.count, dimColor(CRGB(IDLE_LED_COLOR), level));
+    return LED_FRAME_CHANGED;
+}
+
+/********************** STRIP PATTERNS *****************************/
+
+// Rainbow animation with smooth transitions.
+// Everything that doesn't vary along the strip is worked out once per frame; per pixel
+// there is one sin16, 8-bit scales and the HSV conversion.
+static uint8_t renderPride(LedPatternFrame& frame, LedPatternState& state) {
+    PrideState& s = state.pride;
+
+    // Generate smooth sine wave values for saturation and brightness parameters
+    uint8_t sat8 = beatsin88(87, 220, 250);  // Saturation oscillates between 220-250
+    uint8_t brightdepth = beatsin88(341, 96, 224);  // Controls depth of brightness modulation
+    uint8_t brightfloor = 255 - brightdepth;
+    uint16_t brightnessthetainc16 = beatsin88(203, (25 * 256), (40 * 256));  // Controls speed of brightness waves
+    uint8_t msmultiplier = beatsin88(147, 23, 60);  // Time scaling factor
+
+    // Set up hue parameters for color cycling
+    uint16_t hue16 = s.hue16;  // Current base hue value
+    uint16_t hueinc16 = beatsin88(113, 1, 3000);  // How much to increment hue each pixel
+
+    // Calculate time delta since last update
+    uint16_t ms = frame.now;
+    uint16_t deltams = ms - s.lastMillis;
+    s.lastMillis = ms;
+
+    // Update timing variables
+    s.pseudotime += deltams * msmultiplier;  // Advance animation time
+    s.hue16 += deltams * beatsin88(400, 5, 9);  // Slowly shift base hue over time
+    uint16_t brightnesstheta16 = s.pseudotime;  // Starting point for brightness wave
+
+    for (uint16_t i = 0; i < frame.count; i++) {
+        // Increment hue for each LED to create rainbow pattern
+        hue16 += hueinc16;
+        uint8_t hue8 = hue16 >> 8;
+
+        // Brightness wave, squared for sharper peaks, then modulated by the depth
+        brightnesstheta16 += brightnessthetainc16;
+        uint8_t b8 = (sin16(brightnesstheta16) + 32768) >> 8;
+        uint8_t bri8 = scale8(scale8(b8, b8), brightdepth) + brightfloor;
+
+        // Map brightness from 96-224 onto PRIDE_MIN-MAX_BRIGHTNESS on top of itself:
+        // (PRIDE_MAX - PRIDE_MIN) / (224 - 96) = 60/128 = 15/32. Wraps at the very top, as it always has.
+        bri8 += PRIDE_MIN_BRIGHTNESS + (((int16_t)bri8 - 96) * 15 >> 5);
+
+        // Blend new color with existing color for smooth transitions
+        nblend(frame.leds[i], CHSV(hue8, sat8, bri8), 64);
+    }
+    return LED_FRAME_CHANGED;
+}
+
+// Sparkles in from black to the trait color, then flickers like a flame
+static uint8_t renderFlame(LedPatternFrame& frame, LedPatternState& state) {
+    const uint16_t BLEND_START = FLAME_TRANSITION_DURATION / 10 * 7;  // Blend to the color over the last 30%
+    FlameState& s = state.flame;
+    CRGB* leds = frame.leds;
+    uint16_t count = frame.count;
+
+    // Start transition if we haven't yet
+    if (!s.transitionStarted) {
+        s.transitionStarted = true;
+        s.transitionStart = frame.now;
+        fill_solid(leds, count, CRGB::Black);
+    }
+
+    // Handle transition phase
+    if (!s.transitionDone) {
+        uint32_t elapsed = frame.now - s.transitionStart;
+
+        if (elapsed >= FLAME_TRANSITION_DURATION) {
+            // Transition complete, switch to normal flame effect
+            s.transitionDone = true;
+            return LED_FRAME_CHANGED;
+        }
+
+        // Per-frame parameters: how many sparkles, growing with progress, and how far to blend to the trait color
+        uint16_t numSparkles = elapsed * count / (2 * FLAME_TRANSITION_DURATION); // Max 50% of LEDs can sparkle at once
+        uint8_t colorBlend = elapsed > BLEND_START
+            ? (elapsed - BLEND_START) * 255 / (FLAME_TRANSITION_DURATION - BLEND_START) : 0;
+
+        // Fade the previous frame, blending it toward the base color in the same pass once that starts
+        if (colorBlend == 0) {
+            fadeToBlackBy(leds, count, 200);
+        } else {
+            for (uint16_t i = 0; i < count; i++) {
+                leds[i].nscale8(255 - 200);
+                nblend(leds[i], frame.color, colorBlend);
+            }
+        }
+
+        // Add random white sparkles with brightness capped at FLAME_MAX_LEVEL, blended like the rest
+        for (uint16_t i = 0; i < numSparkles; i++) {
+            uint16_t pos = random16(count);
+            if (random8() < 180) { // 70% chance of sparkle
+                leds[pos] = CRGB(FLAME_MAX_LEVEL, FLAME_MAX_LEVEL, FLAME_MAX_LEVEL);
+                leds[pos].fadeToBlackBy(random8(50, 150));
+                if (colorBlend) {
+                    nblend(leds[pos], frame.color, colorBlend);
+                }
+            }
+        }
+        return LED_FRAME_CHANGED;
+    }
+
+    // Normal flame effect
+    if (frame.now - s.lastFlicker >= FLAME_FLICKER_INTERVAL) {
+        s.lastFlicker = frame.now;
+
+        for (uint16_t i = 0; i < count; i++) {
+            leds[i] = frame.color;
+            leds[i].nscale8(random8(FLAME_MIN_LEVEL, FLAME_MAX_LEVEL));
+        }
+        return LED_FRAME_CHANGED;
+    }
+    return LED_FRAME_UNCHANGED;
+}
+
+// The Jungle patterns drive two equal strips, either laid out back to back in the buffer
+// (frame.lanes 2) or mirrored from one strip's worth of it (frame.lanes 1)
+
+// Start of the second strip, which is the first one again when they are mirrored
+static CRGB* secondStrip(LedPatternFrame& frame, uint16_t stripLength) {
+    return frame.lanes > 1 ? frame.leds + stripLength : frame.leds;
+}
+
+// Dim green twinkles on both strips
+static uint8_t renderJungleAmbient(LedPatternFrame& frame, LedPatternState&) {
+    uint16_t stripLength = frame.count / frame.lanes;
+    CRGB* strip2 = secondStrip(frame, stripLength);
+    uint8_t decay = min(frame.steps * 20, 255);
+    fadeToBlackBy(frame.leds, frame.count, decay);
+
+    // Add random dim twinkles
+    if (random8() < 80) {
+        int pos = random16(stripLength);
+        frame.leds[pos] = CRGB(20, 30, 10);
+        strip2[pos] = CRGB(20, 30, 10);
+    }
+    return LED_FRAME_CHANGED;
+}
+
+// A pulse with a fading trail running along each strip, half a strip apart.
+// Mirrored strips show both pulses.
+static uint8_t renderJunglePulse(LedPatternFrame& frame, LedPatternState& state) {
+    const uint8_t MAX_CATCHUP_STEPS = 5;   // Beyond this every pixel has faded out anyway
+    const uint8_t TRAIL_LENGTH = 5;
+    uint16_t stripLength = frame.count / frame.lanes;
+    CRGB* strip2 = secondStrip(frame, stripLength);
+    PulseState& s = state.pulse;
+
+    uint8_t decay = min(frame.steps, MAX_CATCHUP_STEPS) * 40;
+    fadeToBlackBy(frame.leds, frame.count, decay);
+
+    // Create pulses with base color and occasional hue shifts
+    CRGB pulseColor = frame.color;
+    if (random8() < 30) { // 30% chance of hue shift
+        pulseColor = ColorFromPalette(*frame.palette, TRAIT_PALETTE_CENTER + random8(TRAIT_PALETTE_SHIFT(42))); // Shift hue by up to 42 degrees
+    }
+
+    // Draw fading pulse trail
+    uint16_t position2 = (s.position + stripLength / 2) % stripLength;
+    for (uint8_t i = 0; i < TRAIL_LENGTH; i++) {
+        uint16_t pos1 = (s.position + i) % stripLength;
+        uint16_t pos2 = (position2 + i) % stripLength;
+        uint8_t fade = i * 51; // Fade over 5 pixels
+
+        frame.leds[pos1] = pulseColor;
+        frame.leds[pos1].fadeToBlackBy(fade);
+
+        strip2[pos2] = pulseColor;
+        strip2[pos2].fadeToBlackBy(fade);
+    }
+
+    // Move pulse positions by the elapsed steps
+    s.position = (s.position + frame.steps) % stripLength;
+    return LED_FRAME_CHANGED;
+}
+
+/********************** DESCRIPTORS *****************************/
+
+static const char NAME_RAINBOW[] PROGMEM = "rainbow";
+static const char NAME_ORB_CONNECTED[] PROGMEM = "trait_chase";
+static const char NAME_FLASH[] PROGMEM = "flash";
+static const char NAME_ERROR[] PROGMEM = "error";
+static const char NAME_NO_ENERGY[] PROGMEM = "no_energy";
+static const char NAME_IDLE[] PROGMEM = "breathe";
+static const char NAME_PRIDE[] PROGMEM = "pride";
+static const char NAME_FLAME[] PROGMEM = "flame";
+static const char NAME_JUNGLE_AMBIENT[] PROGMEM = "jungle_ambient";
+static const char NAME_JUNGLE_PULSE[] PROGMEM = "jungle_pulse";
+
+const LEDPatternConfig LED_PATTERNS[LED_PATTERN_COUNT] PROGMEM = {
+    {
+        .render = renderRainbow,
+        .name = NAME_RAINBOW,
+        .brightness = 200,
+        .interval = 15,
+        .fadeTime = 250
+    },
+    {
+        .render = renderOrbConnected,
+        .name = NAME_ORB_CONNECTED,
+        .brightness = 255,
+        .interval = 80,
+        .fadeTime = 250
+    },
+    {
+        .render = renderFlash,
+        .name = NAME_FLASH,
+        .brightness = 255,
+        .interval = 10,
+        .fadeTime = 0
+    },
+    {
+        .render = renderError,
+        .name = NAME_ERROR,
+        .brightness = 255,
+        .interval = 5,
+        .fadeTime = 250
+    },
+    {
+        .render = renderNoEnergy,
+        .name = NAME_NO_ENERGY,
+        .brightness = 100,
+        .interval = 200,
+        .fadeTime = 500
+    },
+    {
+        .render = renderBreathe,
+        .name = NAME_IDLE,
+        .brightness = 60,
+        .interval = 40,
+        .fadeTime = 500
+    },
+    {
+        .render = renderPride,
+        .name = NAME_PRIDE,
+        .brightness = 255,
+        .interval = 0,
+        .fadeTime = 250
+    },
+    {
+        .render = renderFlame,
+        .name = NAME_FLAME,
+        .brightness = 255,
+        .interval = 0,
+        .fadeTime = 250
+    },
+    {
+        .render = renderJungleAmbient,
+        .name = NAME_JUNGLE_AMBIENT,
+        .brightness = 255,
+        .interval = 50,
+        .fadeTime = 250
+    },
+    {
+        .render = renderJunglePulse,
+        .name = NAME_JUNGLE_PULSE,
+        .brightness = 255,
+        .interval = 30,
+        .fadeTime = 250
+    }
+};
+
+/********************** ENGINE *****************************/
+
+LedPatternEngine::LedPatternEngine() {
+    start(LED_PATTERN_NO_ORB);
+}
+
+void LedPatternEngine::start(LEDPatternId id) {
+    patternId = id;
+    memcpy_P(&pattern, &LED_PATTERNS[id], sizeof(pattern));
+    interval = pattern.interval;
+    lastStep = 0;
+    firstFrame = true;
+    memset(&state, 0, sizeof(state));
+}
+
+void LedPatternEngine::setInterval(uint16_t newInterval) {
+    interval = newInterval;
+}
+
+uint8_t LedPatternEngine::render(LedPatternFrame& frame) {
+    if (firstFrame || interval == 0) {
+        // A new pattern starts with a single step rather than catching up on the old one's time
+        firstFrame = false;
+        lastStep = frame.now;
+        frame.steps = 1;
+    } else {
+        // Patterns advance by the number of whole steps that elapsed, so a frame rendered
+        // after a stall shows the right phase and speed doesn't depend on loop() load
+        unsigned long elapsed = frame.now - lastStep;
+        if (elapsed < interval) {
+            return LED_FRAME_UNCHANGED;
+        }
+        frame.steps = min(elapsed / interval, 0xFFFFUL);
+        lastStep += (unsigned long)frame.steps * interval;
+    }
+    return pattern.render(frame, state);
+}
@@ -0,0 +1,141 @@
+#ifndef LEDPATTERNS_H
+#define LEDPATTERNS_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+// Data-driven LED patterns. Each pattern is a descriptor in flash (LED_PATTERNS) pointing at a
+// render kernel, and a LedPatternEngine runs one pattern at a time with its state in a single
+// union-sized arena. Adding a pattern costs flash only; RAM is one arena per engine.
+
+enum LEDPatternId {
+    LED_PATTERN_NO_ORB,
+    LED_PATTERN_ORB_CONNECTED,
+    LED_PATTERN_FLASH,
+    LED_PATTERN_ERROR,
+    LED_PATTERN_NO_ENERGY,
+    LED_PATTERN_IDLE,
+    LED_PATTERN_PRIDE,
+    LED_PATTERN_FLAME,
+    LED_PATTERN_JUNGLE_AMBIENT,
+    LED_PATTERN_JUNGLE_PULSE,
+    LED_PATTERN_COUNT
+};
+
+// Kernel results
+#define LED_FRAME_UNCHANGED 0
+#define LED_FRAME_CHANGED   1
+#define LED_FRAME_DONE      2   // A one-shot pattern finished; its owner picks the next one
+
+// Pattern constants
+#define IDLE_LED_COLOR 0x2040FF
+#define PRIDE_MIN_BRIGHTNESS 20
+#define PRIDE_MAX_BRIGHTNESS 80
+#define FLAME_MIN_LEVEL 20
+#define FLAME_MAX_LEVEL 80
+#define FLAME_FLICKER_INTERVAL 150
+#define FLAME_TRANSITION_DURATION 6000
+
+// What a kernel renders into, and with what
+struct LedPatternFrame {
+    CRGB* leds;
+    uint16_t count;
+    uint8_t lanes;       // Equal strips laid out back to back in leds, for patterns that draw per strip (see LedCanvas.h)
+    CRGB color;          // Trait color of the orb on the dock
+    const CRGBPalette16* palette;  // Its hue neighbourhood (see TraitPalette.h)
+    uint8_t energy;
+    unsigned long now;   // ms
+    uint16_t steps;      // Whole pattern steps since the last render, filled in by the engine
+};
+
+// Per-pattern state; only the active pattern's lives in an engine's arena, zeroed on start
+struct RainbowState {
+    uint16_t firstPixelHue;
+};
+
+struct TraitChaseState {
+    uint16_t currentPixel;
+    uint16_t globalPhase;
+    uint16_t huePhase;
+};
+
+struct OrbConnectedState {
+    TraitChaseState chase;
+    uint16_t pulsePhase;    // For the no-energy pulse
+};
+
+struct FlashState {
+    uint16_t elapsedSteps;
+    uint16_t hueOffset;
+};
+
+struct PhaseState {
+    uint16_t phase;
+};
+
+struct PrideState {
+    uint16_t pseudotime;
+    uint16_t lastMillis;
+    uint16_t hue16;
+};
+
+struct FlameState {
+    unsigned long transitionStart;
+    unsigned long lastFlicker;
+    bool transitionStarted;
+    bool transitionDone;
+};
+
+struct PulseState {
+    uint8_t position;
+};
+
+union LedPatternState {
+    RainbowState rainbow;
+    OrbConnectedState orbConnected;
+    FlashState flash;
+    PhaseState phase;
+    PrideState pride;
+    FlameState flame;
+    PulseState pulse;
+};
+
+typedef uint8_t (*LedPatternRender)(LedPatternFrame& frame, LedPatternState& state);
+
+struct LEDPatternConfig {
+    LedPatternRender render;
+    const char* name;           // In flash
+    uint8_t brightness;
+    uint16_t interval;          // ms per step; 0 renders every frame with one step
+    uint16_t fadeTime;          // ms to crossfade in from the previous pattern (see LedCrossfade.h)
+};
+
+// Indexed by LEDPatternId
+extern const LEDPatternConfig LED_PATTERNS[LED_PATTERN_COUNT] PROGMEM;
+
+// Runs one pattern from LED_PATTERNS at a time
+class LedPatternEngine {
+public:
+    LedPatternEngine();
+
+    // Loads a pattern's descriptor from flash and resets its state
+    void start(LEDPatternId id);
+    LEDPatternId getPattern() const { return patternId; }
+    uint8_t getBrightness() const { return pattern.brightness; }
+    uint16_t getFadeTime() const { return pattern.fadeTime; }
+    // Overrides the pattern's step interval until the next start()
+    void setInterval(uint16_t interval);
+
+    // Renders if a step is due; returns LED_FRAME_*
+    uint8_t render(LedPatternFrame& frame);
+
+private:
+    LEDPatternId patternId;
+    LEDPatternConfig pattern;
+    uint16_t interval;
+    unsigned long lastStep;
+    bool firstFrame;
+    LedPatternState state;
+};
+
+#endif // LEDPATTERNS_H
@@ -0,0 +1,54 @@
+#ifndef LED_TABLES_H
+#define LED_TABLES_H
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include <FastLED.h>
+
+// Lookup tables for the ring pattern kernels, so no pattern needs float math per pixel.
+// Generated offline; the formula for each table is given above it. Sine comes from FastLED (sin16).
+
+// Trait chase fade for the pixels 1..11 either side of the chasing dot:
+//   round(255 * ((6 - |i - 6|) / 6)^2), with i = 0 being the two dots themselves at 255
+#define CHASE_FADE_STEPS 12
+const uint8_t CHASE_FADE[CHASE_FADE_STEPS] PROGMEM = {
+    255, 7, 28, 64, 113, 177, 255, 177, 113, 64, 28, 7
+};
+
+// Rainbow palette, one RGB entry per 1024 of 16-bit hue:
+//   gamma8(Adafruit_NeoPixel::ColorHSV(i * 1024)), gamma 2.6
+#define RAINBOW_ENTRIES 64
+const uint8_t RAINBOW_PALETTE[RAINBOW_ENTRIES * 3] PROGMEM = {
+    255,   0,   0, 255,   1,   0, 255,   3,   0, 255,  10,   0,
+    255,  20,   0, 255,  36,   0, 255,  57,   0, 255,  85,   0,
+    255, 120,   0, 255, 164,   0, 255, 215,   0, 235, 255,   0,
+    180, 255,   0, 134, 255,   0,  96, 255,   0,  65, 255,   0,
+     42, 255,   0,  25, 255,   0,  13, 255,   0,   5, 255,   0,
+      1, 255,   0,   0, 255,   0,   0, 255,   0,   0, 255,   2,
+      0, 255,   7,   0, 255,  16,   0, 255,  30,   0, 255,  49,
+      0, 255,  75,   0, 255, 108,   0, 255, 148,   0, 255, 197,
+      0, 255, 255,   0, 197, 255,   0, 148, 255,   0, 108, 255,
+      0,  75, 255,   0,  49, 255,   0,  30, 255,   0,  16, 255,
+      0,   7, 255,   0,   2, 255,   0,   0, 255,   0,   0, 255,
+      1,   0, 255,   5,   0, 255,  13,   0, 255,  25,   0, 255,
+     42,   0, 255,  65,   0, 255,  96,   0, 255, 134,   0, 255,
+    180,   0, 255, 235,   0, 255, 255,   0, 215, 255,   0, 164,
+    255,   0, 120, 255,   0,  85, 255,   0,  57, 255,   0,  36,
+    255,   0,  20, 255,   0,  10, 255,   0,   3, 255,   0,   1
+};
+
+// Gamma-corrected rainbow color for a 16-bit hue, interpolated between palette entries
+inline CRGB rainbowColor(uint16_t hue) {
+    uint8_t index = hue >> 10;
+    uint8_t next = (index + 1) & (RAINBOW_ENTRIES - 1);
+    uint8_t fraction = (hue >> 3) & 0x7F;  // 7 bits keeps the interpolation in 16-bit math
+    CRGB color;
+    for (uint8_t channel = 0; channel < 3; channel++) {
+        int16_t from = pgm_read_byte(&RAINBOW_PALETTE[index * 3 + channel]);
+        int16_t to = pgm_read_byte(&RAINBOW_PALETTE[next * 3 + channel]);
+        color[channel] = from + (((to - from) * fraction) >> 7);
+    }
+    return color;
+}
+
+#endif
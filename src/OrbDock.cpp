@@ -1,16 +1,42 @@
 #include "OrbDock.h"
-
+#include "Crc16.h"
+#if defined(__AVR__)
+#include <avr/sleep.h>
+#endif
+
+// One driver per pin set, built once: each allocates its SPI device and never frees it, so
+// re-inits reuse these rather than constructing new ones
+static Adafruit_PN532 nfcDrivers[PN532_PIN_SET_COUNT] = {
+    Adafruit_PN532(PN532_SCK,  PN532_MISO,  PN532_MOSI,  PN532_SS),
+    Adafruit_PN532(PN532_SCK2, PN532_MISO2, PN532_MOSI2, PN532_SS2),
+    Adafruit_PN532(PN532_SCK1, PN532_MISO1, PN532_MOSI1, PN532_SS1)
+};
 
 // Constructor
 OrbDock::OrbDock(StationId id) :
-    strip(NEOPIXEL_COUNT, NEOPIXEL_PIN, NEO_GRB + NEO_KHZ800),
-    nfc(PN532_SCK, PN532_MISO, PN532_MOSI, PN532_SS) {
+    nfc(&nfcDrivers[0]),
+    ledFrames(LED_TARGET_FPS) {
     // Initialize member variables
     stationId = id;
     isNFCConnected = false;
     isOrbConnected = false;
     isUnformattedNFC = false;
+    memset(nfcUid, 0, sizeof(nfcUid));
     currentMillis = 0;
+    lastNFCCheckTime = 0;
+    nfcCheckInterval = NFC_CHECK_INTERVAL;
+    verifyWrites = NFC_VERIFY_WRITES;
+    nfcPinSet = PN532_PIN_SET_UNKNOWN;
+    memset(&nfcHealth, 0, sizeof(nfcHealth));
+    nfcHealth.healthy = true;
+    isIdle = false;
+    lastNFCActivity = 0;
+    idleTimeout = IDLE_TIMEOUT;
+    nfcPoweredDown = false;
+    useAutoPoll = NFC_USE_AUTOPOLL;
+    autoPollArmed = false;
+    memset(&powerStats, 0, sizeof(powerStats));
+    traitPaletteTrait = 0xFF;
     setLEDPattern(LED_PATTERN_NO_ORB);
 }
 
@@ -20,48 +46,25 @@ OrbDock::~OrbDock() {
 }
 
 void OrbDock::begin() {
-    // Initialize NeoPixel strip
-    strip.begin();
-    strip.setBrightness(0);
-    strip.show();
-
-    // Try to initialize NFC with default pins
-    Serial.println(F("Initializing PN532 NFC reader with latest dock pins..."));
-    nfc.begin();
-    uint32_t versiondata = nfc.getFirmwareVersion();
-    
-    // If default pins don't work, try later dock design pins
-    if (!versiondata) {
-        Serial.println(F("Latest dock pins failed, trying V2 dock pins..."));
-        nfc = Adafruit_PN532(PN532_SCK2, PN532_MISO2, PN532_MOSI2, PN532_SS2); // Later dock design pins
-        nfc.begin();
-        versiondata = nfc.getFirmwareVersion();
-        
-        // If that fails too, try newest pins
-        if (!versiondata) {
-            Serial.println(F("V2 dock pins failed, trying v1 dock pins..."));
-            nfc = Adafruit_PN532(PN532_SCK1, PN532_MISO1, PN532_MOSI1, PN532_SS1);
-            nfc.begin();
-            versiondata = nfc.getFirmwareVersion();
-            
-            // If all pin configurations fail
-            if (!versiondata) {
-                Serial.println(F("Didn't find PN53x board with any pin configuration"));
-                // Flash red LED to indicate error
-                while (1) {
-                    strip.setPixelColor(0, 255, 0, 0); // Red
-                    strip.show();
-                    delay(1000);
-                    strip.setPixelColor(0, 0, 0, 0); // Off
-                    strip.show(); 
-                    delay(1000);
-                }
-            }
-        }
+    // Initialize NeoPixel ring
+    ledEngine.addOutput(LED_OUTPUT_RING, FastLED.addLeds<WS2812B, NEOPIXEL_PIN, GRB>(ring, NEOPIXEL_COUNT), 0);
+    fill_solid(ring, NEOPIXEL_COUNT, CRGB::Black);
+    fill_solid(ringCanvas, NEOPIXEL_COUNT, CRGB::Black);
+    ledEngine.show(LED_OUTPUT_RING);
+
+    // Try each dock design's pins until the PN532 answers
+    bool found = false;
+    for (uint8_t pinSet = 0; pinSet < PN532_PIN_SET_COUNT && !found; pinSet++) {
+        Serial.print(F("Initializing PN532 NFC reader with pin set "));
+        Serial.println(pinSet);
+        found = initNFC(pinSet);
     }
 
-    nfc.SAMConfig();                        // Configure the PN532 to read RFID tags
-    nfc.setPassiveActivationRetries(0x11);  // Set the max number of retry attempts to read from a card
+    // Keep running without a reader; the health monitor keeps trying to bring it up
+    if (!found) {
+        Serial.println(F("Didn't find PN53x board with any pin configuration"));
+        markNFCDown();
+    }
 
     Serial.print(F("Station: "));
     Serial.println(STATION_NAMES[stationId]);
@@ -69,30 +72,68 @@ void OrbDock::begin() {
 }
 
 void OrbDock::loop() {
+    // While idle, sleep until the next interrupt (at most one millis() tick) instead of spinning
+    if (isIdle) {
+        sleepCPU();
+    }
     currentMillis = millis();
 
-    // Run LED patterns
-    runLEDPatterns();
+    // Render and latch LED frames at the target frame rate
+    runLEDFrame();
+    reportPower();
+
+    // Handle snapshot/restore requests from the host. The latch guard sees the bytes before
+    // they are read, or a steady stream read as it arrives would look like a quiet line.
+    serialLatch.poll(micros());
+    handleSerialCommands();
+    serialLatch.afterRead();
 
-    // Check for NFC / Orb presence periodically
-    static unsigned long lastNFCCheckTime = 0;
-    if (currentMillis - lastNFCCheckTime < NFC_CHECK_INTERVAL) {
+    // Keep the reader healthy; NFC is skipped while it recovers
+    if (!monitorNFC()) {
         return;
     }
-    lastNFCCheckTime = currentMillis;
 
-    // First, check if previously connected NFC is still present
-    if (isNFCConnected) {
-        if (!isNFCPresent()) {
-            // NFC has been removed, reset all states
-            endOrbSession();
+    // Drop into low power idle after a quiet period
+    if (!isIdle && idleTimeout > 0 && !isNFCConnected && currentMillis - lastNFCActivity >= idleTimeout) {
+        enterIdle();
+    }
+
+    bool detected;
+    if (useAutoPoll && !isIdle && !isNFCConnected) {
+        // The PN532 hunts for tags on its own; only its result needs checking
+        detected = checkAutoPoll();
+    } else {
+        // Check for NFC / Orb presence periodically
+        if (currentMillis - lastNFCCheckTime < (isIdle ? IDLE_NFC_CHECK_INTERVAL : nfcCheckInterval)) {
+            return;
+        }
+        lastNFCCheckTime = currentMillis;
+
+        // First, check if previously connected NFC is still present
+        if (isNFCConnected) {
+            if (!isNFCPresent()) {
+                // NFC has been removed, reset all states
+                endOrbSession();
+            }
+            return;
+        }
+
+        // Check for new NFC presence. While idle the PN532 is only woken up for the check itself.
+        if (isIdle && !wakeNFC()) {
             return;
         }
+        detected = isNFCPresent();
+        if (!detected && isIdle) {
+            powerDownNFC();
+        }
     }
 
-    // Check for new NFC presence
-    if(!isNFCConnected && isNFCPresent()) {
+    if (detected) {
+        if (isIdle) {
+            exitIdle();
+        }
         isNFCConnected = true;
+        lastNFCActivity = currentMillis;
         // NFC is present! Check if it's an orb
         int orbStatus = isOrb();
         switch (orbStatus) {
@@ -119,16 +160,362 @@ void OrbDock::loop() {
     }
 }
 
+/********************** NFC HEALTH *****************************/
+
+// Initializes the PN532 on the given pin set. Returns false if it doesn't answer.
+bool OrbDock::initNFC(uint8_t pinSet) {
+    nfc = &nfcDrivers[pinSet];
+    nfc->begin();
+    if (!nfc->getFirmwareVersion()) {
+        return false;
+    }
+    nfc->SAMConfig();                        // Configure the PN532 to read RFID tags
+    nfc->setPassiveActivationRetries(0x11);  // Set the max number of retry attempts to read from a card
+    nfcPinSet = pinSet;
+    nfcPoweredDown = false;
+    return true;
+}
+
+// Probes the PN532 while idle and recovers it in the background once it stops answering:
+// first by re-running SAMConfig, then with a full re-init. Returns false while the reader is down.
+bool OrbDock::monitorNFC() {
+    if (nfcHealth.healthy) {
+        if (!isNFCConnected && !nfcPoweredDown && currentMillis - nfcHealth.lastCheck >= NFC_HEALTH_CHECK_INTERVAL) {
+            nfcHealth.lastCheck = currentMillis;
+            abortAutoPoll();
+            if (!nfc->getFirmwareVersion()) {
+                Serial.println(F("PN532 stopped answering"));
+                markNFCDown();
+            }
+        }
+        if (nfcHealth.healthy) {
+            return true;
+        }
+    }
+
+    // A session can't survive the reader going down
+    if (isNFCConnected) {
+        endOrbSession();
+        setLEDPattern(LED_PATTERN_ERROR);
+    }
+
+    if (currentMillis - nfcHealth.lastRecoveryAttempt < NFC_RECOVERY_INTERVAL) {
+        return false;
+    }
+    nfcHealth.lastRecoveryAttempt = currentMillis;
+    nfcHealth.recoveryAttempts++;
+
+    bool recovered;
+    if (nfcPinSet != PN532_PIN_SET_UNKNOWN && nfcHealth.recoveryAttempts <= NFC_SAM_RECOVERY_ATTEMPTS) {
+        Serial.println(F("Recovering PN532: SAMConfig"));
+        recovered = nfc->getFirmwareVersion() && nfc->SAMConfig();
+    } else {
+        // If the reader never came up, keep cycling through the pin sets
+        uint8_t pinSet = nfcPinSet != PN532_PIN_SET_UNKNOWN ? nfcPinSet : nfcHealth.recoveryAttempts % PN532_PIN_SET_COUNT;
+        Serial.println(F("Recovering PN532: re-init"));
+        recovered = initNFC(pinSet);
+    }
+    if (!recovered) {
+        return false;
+    }
+
+    unsigned long downtime = millis() - nfcHealth.downSince;
+    nfcHealth.healthy = true;
+    nfcHealth.consecutiveFailures = 0;
+    nfcHealth.lastCheck = currentMillis;
+    nfcHealth.recoveries++;
+    nfcHealth.totalRecoveryTime += downtime;
+    Serial.print(F("PN532 recovered after "));
+    Serial.print(downtime);
+    Serial.print(F(" ms, mean time to recover "));
+    Serial.print(nfcHealth.totalRecoveryTime / nfcHealth.recoveries);
+    Serial.println(F(" ms"));
+    isIdle = false;
+    lastNFCActivity = currentMillis;
+    setLEDPattern(LED_PATTERN_NO_ORB);
+    return true;
+}
+
+// Called when a transaction fails after all retries. A few in a row could just be a tag
+// pulled mid-read, so the PN532 is only marked down if it also stops answering.
+void OrbDock::recordNFCFailure() {
+    if (++nfcHealth.consecutiveFailures < NFC_FAILURE_THRESHOLD) {
+        return;
+    }
+    nfcHealth.consecutiveFailures = 0;
+    abortAutoPoll();
+    if (!nfc->getFirmwareVersion()) {
+        Serial.println(F("PN532 stopped answering"));
+        markNFCDown();
+    }
+}
+
+// Switches to degraded mode: LED animations keep running while the monitor recovers the reader
+void OrbDock::markNFCDown() {
+    nfcHealth.healthy = false;
+    abortAutoPoll();
+    nfcHealth.recoveryAttempts = 0;
+    nfcHealth.downSince = millis();
+    nfcHealth.lastRecoveryAttempt = nfcHealth.downSince;
+    setLEDPattern(LED_PATTERN_ERROR);
+}
+
+/********************** LOW POWER IDLE *****************************/
+
+void OrbDock::setAutoPoll(bool enabled) {
+    useAutoPoll = enabled;
+    abortAutoPoll();
+}
+
+void OrbDock::setIdleTimeout(uint32_t timeout) {
+    idleTimeout = timeout;
+}
+
+void OrbDock::enterIdle() {
+    Serial.println(F("Going idle"));
+    isIdle = true;
+    setLEDPattern(LED_PATTERN_IDLE);
+    powerDownNFC();
+}
+
+void OrbDock::exitIdle() {
+    Serial.println(F("Waking from idle"));
+    isIdle = false;
+    setLEDPattern(LED_PATTERN_NO_ORB);
+}
+
+// The PN532 wakes on the SS edge of the next command, but may drop that first command
+bool OrbDock::wakeNFC() {
+    if (!nfcPoweredDown) {
+        return true;
+    }
+    nfcPoweredDown = false;
+    powerStats.nfcAwakeSince = millis();
+    if (nfc->SAMConfig() || nfc->SAMConfig()) {
+        return true;
+    }
+    recordNFCFailure();
+    return false;
+}
+
+// Puts the PN532 into PowerDown with the RF field off until the next command
+void OrbDock::powerDownNFC() {
+    if (nfcPoweredDown) {
+        return;
+    }
+    uint8_t command[2] = {PN532_COMMAND_POWERDOWN, NFC_POWERDOWN_WAKEUP};
+    abortAutoPoll();
+    if (!nfc->sendCommandCheckAck(command, sizeof(command))) {
+        return;
+    }
+    // The PN532 only goes to sleep once its response has been read
+    uint8_t status;
+    if (!waitNFCResponse(NFC_RESPONSE_TIMEOUT)) {
+        return;
+    }
+    readNFCResponse(&status, 1);
+    nfcPoweredDown = true;
+    powerStats.nfcAwakeMillis += millis() - powerStats.nfcAwakeSince;
+}
+
+void OrbDock::sleepCPU() {
+#if defined(__AVR__)
+    unsigned long start = micros();
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_mode();
+    powerStats.mcuSleepMicros += micros() - start;
+#endif
+}
+
+// Periodically prints duty cycles and the average current they imply
+void OrbDock::reportPower() {
+    unsigned long window = currentMillis - powerStats.windowStart;
+    if (window < POWER_REPORT_INTERVAL) {
+        return;
+    }
+    unsigned long nfcAwake = powerStats.nfcAwakeMillis;
+    if (!nfcPoweredDown) {
+        nfcAwake += currentMillis - max(powerStats.nfcAwakeSince, powerStats.windowStart);
+    }
+    // Duty cycles in per mille
+    uint32_t mcuSleep = min(powerStats.mcuSleepMicros / window, 1000UL);
+    uint32_t nfcDuty = min(nfcAwake * 1000 / window, 1000UL);
+    uint32_t mcuCurrent = (CURRENT_MCU_ACTIVE * (1000 - mcuSleep) + CURRENT_MCU_SLEEP * mcuSleep) / 1000;
+    uint32_t nfcCurrent = (CURRENT_NFC_ACTIVE * nfcDuty + CURRENT_NFC_POWERDOWN * (1000 - nfcDuty)) / 1000;
+    uint32_t ledCurrent = powerStats.ledFrames > 0 ?
+        powerStats.ledLevelSum / powerStats.ledFrames * (CURRENT_LED_CHANNEL / 255) : 0;
+
+    Serial.print(F("Power: MCU asleep "));
+    Serial.print(mcuSleep / 10);
+    Serial.print(F("%, PN532 awake "));
+    Serial.print(nfcDuty / 10);
+    Serial.print(F("%, est. "));
+    Serial.print((mcuCurrent + nfcCurrent + ledCurrent) / 1000);
+    Serial.print(F(" mA (LEDs "));
+    Serial.print(ledCurrent / 1000);
+    Serial.println(F(" mA)"));
+
+    memset(&powerStats, 0, sizeof(powerStats));
+    powerStats.windowStart = currentMillis;
+    powerStats.nfcAwakeSince = currentMillis;
+}
+
+/********************** RAW PN532 SPI *****************************/
+
+// Bit-bangs one byte on the PN532's software SPI pins (mode 0, LSB first), as Adafruit_PN532 does
+uint8_t OrbDock::nfcTransfer(uint8_t data) {
+    const uint8_t* pins = PN532_PIN_SETS[nfcPinSet];
+    uint8_t result = 0;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        digitalWrite(pins[2], (data >> bit) & 1);
+        digitalWrite(pins[0], HIGH);
+        if (digitalRead(pins[1])) {
+            result |= 1 << bit;
+        }
+        digitalWrite(pins[0], LOW);
+    }
+    return result;
+}
+
+bool OrbDock::isNFCResponseReady() {
+    uint8_t ss = PN532_PIN_SETS[nfcPinSet][3];
+    digitalWrite(ss, LOW);
+    nfcTransfer(PN532_SPI_STATREAD);
+    bool ready = nfcTransfer(0) == PN532_SPI_READY;
+    digitalWrite(ss, HIGH);
+    return ready;
+}
+
+bool OrbDock::waitNFCResponse(uint16_t timeout) {
+    unsigned long start = millis();
+    while (!isNFCResponseReady()) {
+        if (millis() - start > timeout) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Reads a response frame and copies its data (after the TFI and command code) into response.
+// Returns the data length, or -1 if the frame is malformed.
+int OrbDock::readNFCResponse(uint8_t* response, uint8_t maxLength) {
+    uint8_t ss = PN532_PIN_SETS[nfcPinSet][3];
+    digitalWrite(ss, LOW);
+    nfcTransfer(PN532_SPI_DATAREAD);
+
+    // Preamble and start code: 00 00 FF
+    int length = -1;
+    if (nfcTransfer(0) == 0x00 && nfcTransfer(0) == 0x00 && nfcTransfer(0) == 0xFF) {
+        uint8_t frameLength = nfcTransfer(0);
+        uint8_t lengthChecksum = nfcTransfer(0);
+        if (frameLength >= 2 && static_cast<uint8_t>(frameLength + lengthChecksum) == 0 &&
+            nfcTransfer(0) == PN532_PN532TOHOST) {
+            nfcTransfer(0);  // Command code
+            length = frameLength - 2;
+            for (int i = 0; i < length; i++) {
+                uint8_t data = nfcTransfer(0);
+                if (i < maxLength) {
+                    response[i] = data;
+                }
+            }
+            length = min(length, static_cast<int>(maxLength));
+        }
+    }
+    digitalWrite(ss, HIGH);
+    return length;
+}
+
+// Runs InDataExchange with target 1, the target activated by either InListPassiveTarget or InAutoPoll.
+// Returns the length of the tag's response, or -1 on error.
+int OrbDock::nfcDataExchange(const uint8_t* send, uint8_t sendLength, uint8_t* response, uint8_t maxLength) {
+    uint8_t command[4] = {PN532_COMMAND_INDATAEXCHANGE, 1};
+    if (sendLength > sizeof(command) - 2) {
+        return -1;
+    }
+    memcpy(command + 2, send, sendLength);
+    if (!nfc->sendCommandCheckAck(command, sendLength + 2) || !waitNFCResponse(NFC_RESPONSE_TIMEOUT)) {
+        return -1;
+    }
+
+    // Status byte, then the tag's response
+    uint8_t frame[1 + NTAG_READ_BYTES];
+    int length = readNFCResponse(frame, sizeof(frame));
+    if (length < 1 || (frame[0] & 0x3F) != 0) {
+        return -1;
+    }
+    length = min(length - 1, static_cast<int>(maxLength));
+    memcpy(response, frame + 1, length);
+    return length;
+}
+
+// Arms InAutoPoll if needed and picks up the UID once the PN532 reports a target,
+// so no further anticollision round is needed.
+bool OrbDock::checkAutoPoll() {
+    if (!autoPollArmed) {
+        uint8_t command[4] = {PN532_COMMAND_INAUTOPOLL, 0xFF, NFC_AUTOPOLL_PERIOD, NFC_AUTOPOLL_TYPE};
+        if (!nfc->sendCommandCheckAck(command, sizeof(command))) {
+            recordNFCFailure();
+            return false;
+        }
+        autoPollArmed = true;
+        lastNFCCheckTime = currentMillis;
+        return false;
+    }
+
+    if (currentMillis - lastNFCCheckTime < NFC_AUTOPOLL_READY_INTERVAL) {
+        return false;
+    }
+    lastNFCCheckTime = currentMillis;
+    if (!isNFCResponseReady()) {
+        return false;
+    }
+    autoPollArmed = false;
+
+    // NbTg | Type | Length | Tg | SENS_RES (2) | SEL_RES | NFCID length | NFCID
+    uint8_t response[8 + NFC_UID_LENGTH];
+    int length = readNFCResponse(response, sizeof(response));
+    if (length < static_cast<int>(sizeof(response)) || response[0] < 1) {
+        return false;
+    }
+    if (response[7] != NFC_UID_LENGTH) {
+        Serial.println(F("Detected non-NTAG203 tag (UUID length != 7 bytes)!"));
+        return false;
+    }
+    memcpy(nfcUid, response + 8, NFC_UID_LENGTH);
+    Serial.println(F("NFC tag read successfully"));
+    return true;
+}
+
+// Stops a running InAutoPoll before the PN532 is sent another command. The user manual's way to
+// abort a command in progress is for the host to send an ACK frame (00 00 FF 00 FF 00).
+void OrbDock::abortAutoPoll() {
+    if (!autoPollArmed) {
+        return;
+    }
+    autoPollArmed = false;
+    static const uint8_t ACK_FRAME[6] = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+    uint8_t ss = PN532_PIN_SETS[nfcPinSet][3];
+    digitalWrite(ss, LOW);
+    nfcTransfer(PN532_SPI_DATAWRITE);
+    for (uint8_t i = 0; i < sizeof(ACK_FRAME); i++) {
+        nfcTransfer(ACK_FRAME[i]);
+    }
+    digitalWrite(ss, HIGH);
+}
+
+/********************** NFC FUNCTIONS *****************************/
+
 bool OrbDock::isNFCPresent() {
-    uint8_t uid[7];  // Buffer to store the returned UID
+    uint8_t uid[NFC_UID_LENGTH];  // Buffer to store the returned UID
     uint8_t uidLength;
-    if (!nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength, 30)) {
+    if (!nfc->readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength, 30)) {
         return false;
     }
-    if (uidLength != 7) {
+    if (uidLength != NFC_UID_LENGTH) {
         Serial.println(F("Detected non-NTAG203 tag (UUID length != 7 bytes)!"));
         return false;
     }
+    memcpy(nfcUid, uid, NFC_UID_LENGTH);
     Serial.println(F("NFC tag read successfully"));
     return true;
 }
@@ -186,6 +573,7 @@ void OrbDock::printOrbInfo() {
 
 void OrbDock::endOrbSession() {
     setLEDPattern(LED_PATTERN_NO_ORB);
+    lastNFCActivity = currentMillis;
     isOrbConnected = false;
     isNFCConnected = false;
     isUnformattedNFC = false;
@@ -195,14 +583,14 @@ void OrbDock::endOrbSession() {
 }
 
 int OrbDock::writeStation(int stationId) {
-    // Prepare the page buffer with station data
-    page_buffer[0] = orbInfo.stations[stationId].visited ? 1 : 0;
-    page_buffer[1] = orbInfo.stations[stationId].custom;
-    page_buffer[2] = 0;
-    page_buffer[3] = 0;
-
-    // Write the buffer to the NFC
-    int writeDataStatus = writePage(STATIONS_PAGE_OFFSET + stationId, page_buffer);
+    // Prepare the page with station data
+    uint8_t stationBytes[4] = {
+        static_cast<uint8_t>(orbInfo.stations[stationId].visited ? 1 : 0),
+        orbInfo.stations[stationId].custom, 0, 0
+    };
+
+    // Write the page to the NFC
+    int writeDataStatus = writePages(STATIONS_PAGE_OFFSET + stationId, stationBytes, 1);
     if (writeDataStatus == STATUS_FAILED) {
         Serial.println("Failed to write station");
         return STATUS_FAILED;
@@ -211,13 +599,17 @@ int OrbDock::writeStation(int stationId) {
 }
 
 int OrbDock::writePage(int page, uint8_t* data) {
+    if (!nfcHealth.healthy) {
+        return STATUS_FAILED;
+    }
     int retryCount = 0;
     while (retryCount < MAX_RETRIES) {
         Serial.print(F("Writing to page "));
         Serial.println(page);
         
-        if (nfc.ntag2xx_WritePage(page, data)) {
+        if (nfc->ntag2xx_WritePage(page, data)) {
             Serial.println(F("Write succeeded"));
+            nfcHealth.consecutiveFailures = 0;
             return STATUS_SUCCEEDED;
         }
         
@@ -225,18 +617,85 @@ int OrbDock::writePage(int page, uint8_t* data) {
         if (retryCount < MAX_RETRIES) {
             Serial.println(F("Retrying write"));
             //delay(RETRY_DELAY);
-            nfc.inListPassiveTarget();
+            nfc->inListPassiveTarget();
         }
     }
 
     Serial.println(F("Write failed after retries"));
+    recordNFCFailure();
     return STATUS_FAILED;
 }
 
+// Writes pages that differ from what's already on the tag. Works through 4-page blocks: one READ
+// finds the pages that need writing and, in verify mode, one READ per block checks them afterwards,
+// rewriting only the pages that didn't take.
+int OrbDock::writePages(int startPage, const uint8_t* data, int count, int* pagesWritten) {
+    uint8_t block[NTAG_READ_BYTES];
+    int written = 0;
+    for (int first = 0; first < count; first += NTAG_READ_PAGES) {
+        int blockPages = min(NTAG_READ_PAGES, count - first);
+        if (readPages(startPage + first, block) == STATUS_FAILED) {
+            return STATUS_FAILED;
+        }
+        uint8_t pending = mismatchedPages(block, data + first * 4, blockPages);
+
+        int attempts = 0;
+        while (pending) {
+            if (attempts++ == MAX_RETRIES) {
+                Serial.println(F("Verify failed after retries"));
+                return STATUS_FAILED;
+            }
+            for (int i = 0; i < blockPages; i++) {
+                if (!(pending & (1 << i))) {
+                    continue;
+                }
+                memcpy(page_buffer, data + (first + i) * 4, 4);
+                if (writePage(startPage + first + i, page_buffer) == STATUS_FAILED) {
+                    return STATUS_FAILED;
+                }
+                written++;
+            }
+            if (!verifyWrites) {
+                break;
+            }
+            if (readPages(startPage + first, block) == STATUS_FAILED) {
+                return STATUS_FAILED;
+            }
+            pending = mismatchedPages(block, data + first * 4, blockPages);
+            if (pending) {
+                Serial.println(F("Verify failed, rewriting"));
+            }
+        }
+    }
+    if (pagesWritten) {
+        *pagesWritten = written;
+    }
+    return STATUS_SUCCEEDED;
+}
+
+// Returns a bit mask of the pages in a 4-page block that differ from the expected data
+uint8_t OrbDock::mismatchedPages(const uint8_t* block, const uint8_t* expected, int count) {
+    uint8_t mask = 0;
+    for (int i = 0; i < count; i++) {
+        if (memcmp(block + i * 4, expected + i * 4, 4) != 0) {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+}
+
+void OrbDock::setWriteVerification(bool enabled) {
+    verifyWrites = enabled;
+}
+
 int OrbDock::readPage(int page) {
+    if (!nfcHealth.healthy) {
+        return STATUS_FAILED;
+    }
     int retryCount = 0;
     while (retryCount < MAX_RETRIES) {
-        if (nfc.ntag2xx_ReadPage(page, page_buffer)) {
+        if (nfc->ntag2xx_ReadPage(page, page_buffer)) {
+            nfcHealth.consecutiveFailures = 0;
             return STATUS_SUCCEEDED;
         }
         
@@ -244,19 +703,46 @@ int OrbDock::readPage(int page) {
         if (retryCount < MAX_RETRIES) {
             Serial.println(F("Retrying read"));
             delay(RETRY_DELAY);
-            nfc.inListPassiveTarget();
+            nfc->inListPassiveTarget();
         }
     }
 
     Serial.println(F("Read failed after retries"));
+    recordNFCFailure();
+    return STATUS_FAILED;
+}
+
+// Reads 4 consecutive pages with a single NTAG READ. Reads past the last page wrap around to page 0.
+int OrbDock::readPages(int page, uint8_t* buffer) {
+    if (!nfcHealth.healthy) {
+        return STATUS_FAILED;
+    }
+    uint8_t command[2] = {NTAG_CMD_READ, static_cast<uint8_t>(page)};
+    int retryCount = 0;
+    while (retryCount < MAX_RETRIES) {
+        if (nfcDataExchange(command, sizeof(command), buffer, NTAG_READ_BYTES) == NTAG_READ_BYTES) {
+            nfcHealth.consecutiveFailures = 0;
+            return STATUS_SUCCEEDED;
+        }
+
+        retryCount++;
+        if (retryCount < MAX_RETRIES) {
+            Serial.println(F("Retrying read"));
+            delay(RETRY_DELAY);
+            nfc->inListPassiveTarget();
+        }
+    }
+
+    Serial.println(F("Read failed after retries"));
+    recordNFCFailure();
     return STATUS_FAILED;
 }
 
 // Read and print the entire NFC storage
 void OrbDock::printNFCStorage() {
-    // Read the entire NFC storage
-    for (int i = 0; i < 45; i++) {
-        if (readPage(i) == STATUS_FAILED) {
+    uint8_t block[NTAG_READ_BYTES];
+    for (int i = 0; i < NFC_PAGE_COUNT; i++) {
+        if (i % NTAG_READ_PAGES == 0 && readPages(i, block) == STATUS_FAILED) {
             Serial.println(F("Failed to read page"));
             return;
         }
@@ -264,13 +750,140 @@ void OrbDock::printNFCStorage() {
         Serial.print(i);
         Serial.print(F(": "));
         for (int j = 0; j < 4; j++) {
-            Serial.print(page_buffer[j]);
+            Serial.print(block[(i % NTAG_READ_PAGES) * 4 + j]);
             Serial.print(F(" "));
         }
         Serial.println();
     }
 }
 
+/********************** SERIAL COMMANDS *****************************/
+
+// Takes every byte waiting, so a dock's protocol frames are parsed within one loop. Stops after a
+// command that blocks, so LED frames and NFC get a turn before the next one.
+void OrbDock::handleSerialCommands() {
+    while (Serial.available()) {
+        uint8_t command = Serial.read();
+        if (onSerialByte(command)) {
+            continue;
+        }
+        switch (command) {
+            case SERIAL_CMD_SNAPSHOT:
+                snapshotNFC();
+                return;
+            case SERIAL_CMD_RESTORE:
+                restoreNFC();
+                return;
+            case SERIAL_CMD_BENCHMARK:
+                benchmarkLEDKernels();
+                return;
+            case SERIAL_CMD_FRAME_STATS:
+                ledFrames.printStats();
+                serialLatch.printStats();
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Streams the whole tag as a framed binary image (see ORB_IMAGE_* in OrbDock.h)
+void OrbDock::snapshotNFC() {
+    if (!isNFCConnected) {
+        Serial.println(F("SNAPSHOT FAILED: no NFC"));
+        return;
+    }
+
+    // Read everything before sending anything, so a failed read never leaves a partial frame on the wire
+    uint8_t pages[NFC_PAGE_COUNT * 4];
+    uint8_t block[NTAG_READ_BYTES];
+    for (int page = 0; page < NFC_PAGE_COUNT; page += NTAG_READ_PAGES) {
+        if (readPages(page, block) == STATUS_FAILED) {
+            Serial.println(F("SNAPSHOT FAILED: read error"));
+            return;
+        }
+        int count = min(NTAG_READ_PAGES, NFC_PAGE_COUNT - page);
+        memcpy(pages + page * 4, block, count * 4);
+    }
+
+    uint8_t header[ORB_IMAGE_HEADER_SIZE];
+    memcpy(header, ORB_IMAGE_MAGIC, 4);
+    header[4] = ORB_IMAGE_VERSION;
+    header[5] = NFC_UID_LENGTH;
+    memcpy(header + 6, nfcUid, NFC_UID_LENGTH);
+    header[13] = 0;
+    header[14] = NFC_PAGE_COUNT;
+
+    uint16_t crc = crc16Update(CRC16_INIT, header, sizeof(header));
+    crc = crc16Update(crc, pages, sizeof(pages));
+    Serial.write(header, sizeof(header));
+    Serial.write(pages, sizeof(pages));
+    Serial.write(static_cast<uint8_t>(crc >> 8));
+    Serial.write(static_cast<uint8_t>(crc));
+}
+
+// Receives an image and writes back the user pages that differ from the tag.
+// The image must come from the same tag (matching UID) and pass its CRC before anything is written.
+void OrbDock::restoreNFC() {
+    uint8_t header[ORB_IMAGE_HEADER_SIZE];
+    if (Serial.readBytes(header, sizeof(header)) != sizeof(header)) {
+        Serial.println(F("RESTORE FAILED: timeout"));
+        return;
+    }
+    if (memcmp(header, ORB_IMAGE_MAGIC, 4) != 0 || header[4] != ORB_IMAGE_VERSION ||
+        header[5] != NFC_UID_LENGTH || header[13] != 0 || header[14] != NFC_PAGE_COUNT) {
+        Serial.println(F("RESTORE FAILED: bad header"));
+        return;
+    }
+
+    // Only the user pages are kept; the rest are read through the CRC
+    uint8_t pages[(NFC_USER_PAGE_LAST - PAGE_OFFSET + 1) * 4];
+    uint16_t crc = crc16Update(CRC16_INIT, header, sizeof(header));
+    for (int page = 0; page < NFC_PAGE_COUNT; page++) {
+        uint8_t data[4];
+        if (Serial.readBytes(data, 4) != 4) {
+            Serial.println(F("RESTORE FAILED: timeout"));
+            return;
+        }
+        crc = crc16Update(crc, data, 4);
+        if (page >= PAGE_OFFSET && page <= NFC_USER_PAGE_LAST) {
+            memcpy(pages + (page - PAGE_OFFSET) * 4, data, 4);
+        }
+    }
+    uint8_t crcBytes[2];
+    if (Serial.readBytes(crcBytes, 2) != 2) {
+        Serial.println(F("RESTORE FAILED: timeout"));
+        return;
+    }
+    if (crc != ((uint16_t)crcBytes[0] << 8 | crcBytes[1])) {
+        Serial.println(F("RESTORE FAILED: bad CRC"));
+        return;
+    }
+
+    if (!isNFCConnected) {
+        Serial.println(F("RESTORE FAILED: no NFC"));
+        return;
+    }
+    if (memcmp(header + 6, nfcUid, NFC_UID_LENGTH) != 0) {
+        Serial.println(F("RESTORE FAILED: UID mismatch"));
+        return;
+    }
+
+    // Only the pages that differ get written
+    int written = 0;
+    if (writePages(PAGE_OFFSET, pages, NFC_USER_PAGE_LAST - PAGE_OFFSET + 1, &written) == STATUS_FAILED) {
+        Serial.println(F("RESTORE FAILED: write error"));
+        return;
+    }
+
+    if (isOrbConnected) {
+        readOrbInfo();
+    }
+    Serial.print(F("RESTORE OK: "));
+    Serial.print(written);
+    Serial.println(F(" pages written"));
+}
+
 // Returns the trait name
 const char* OrbDock::getTraitName() {
     int traitIndex = static_cast<int>(orbInfo.trait);
@@ -289,8 +902,7 @@ int OrbDock::setTrait(TraitId newTrait) {
     Serial.println(TRAIT_NAMES[static_cast<int>(newTrait)]);
     orbInfo.trait = newTrait;
     uint8_t traitBytes[4] = {static_cast<uint8_t>(newTrait), 0, 0, 0};  // Convert trait to bytes
-    memcpy(page_buffer, traitBytes, 4);
-    return writePage(TRAIT_PAGE, page_buffer);
+    return writePages(TRAIT_PAGE, traitBytes, 1);
 }
 
 int OrbDock::setVisited(bool visited) {
@@ -307,8 +919,7 @@ int OrbDock::setEnergy(byte energy) {
     Serial.println(energy);
     orbInfo.energy = energy;
     byte energyBytes[4] = {energy, 0, 0, 0};  // Convert energy to bytes
-    memcpy(page_buffer, energyBytes, 4);
-    int result = writePage(ENERGY_PAGE, page_buffer);
+    int result = writePages(ENERGY_PAGE, energyBytes, 1);
     if (result == STATUS_SUCCEEDED) {
         setLEDPattern(LED_PATTERN_FLASH);
     }
@@ -355,36 +966,21 @@ void OrbDock::handleError(const char* message) {
 // Formats the NFC with "ORBS" header, default station information and given trait
 int OrbDock::formatNFC(TraitId trait) {
     Serial.println(F("Formatting NFC with ORBS header, default station information and given trait..."));
-    
-    // Store the trait we want to set
-    orbInfo.trait = trait;
-    
-    // Write header
-    memcpy(page_buffer, ORBS_HEADER, 4);
-    if (writePage(ORBS_PAGE, page_buffer) == STATUS_FAILED) {
-        return STATUS_FAILED;
-    }
-    
-    // Write trait first
-    if (setTrait(trait) == STATUS_FAILED) {
-        return STATUS_FAILED;
-    }
-    
-    // Then reset stations
-    if (resetOrb() == STATUS_FAILED) {
-        return STATUS_FAILED;
-    }
-    
-    // Write trait again to ensure it wasn't cleared
-    if (setTrait(trait) == STATUS_FAILED) {
-        return STATUS_FAILED;
-    }
-    
-    // Write energy
-    if (setEnergy(INIT_ENERGY) == STATUS_FAILED) {
+
+    // Lay out the whole formatted orb and write only the pages that differ
+    uint8_t pages[ORB_PAGE_COUNT * 4];
+    memset(pages, 0, sizeof(pages));
+    memcpy(pages, ORBS_HEADER, 4);
+    pages[(TRAIT_PAGE - ORBS_PAGE) * 4] = static_cast<uint8_t>(trait);
+    pages[(ENERGY_PAGE - ORBS_PAGE) * 4] = INIT_ENERGY;
+    if (writePages(ORBS_PAGE, pages, ORB_PAGE_COUNT) == STATUS_FAILED) {
+        Serial.println(F("Failed to format NFC"));
         return STATUS_FAILED;
     }
-    
+
+    orbInfo.trait = trait;
+    orbInfo.energy = INIT_ENERGY;
+    reInitializeStations();
     setLEDPattern(LED_PATTERN_ORB_CONNECTED);
 
     return STATUS_SUCCEEDED;
@@ -418,30 +1014,25 @@ void OrbDock::reInitializeStations() {
 // Read station information and trait from orb
 int OrbDock::readOrbInfo() {
     Serial.println("Reading trait and station information from orb...");
-    
-    // Read stations
-    for (int i = 0; i < NUM_STATIONS; i++) {
-        if (readPage(STATIONS_PAGE_OFFSET + i) == STATUS_FAILED) {
-            Serial.println(F("Failed to read station information"));
+
+    // Read trait, energy and stations 4 pages at a time
+    uint8_t block[NTAG_READ_BYTES];
+    for (int page = TRAIT_PAGE; page < STATIONS_PAGE_OFFSET + NUM_STATIONS; page++) {
+        int index = page - TRAIT_PAGE;
+        if (index % NTAG_READ_PAGES == 0 && readPages(page, block) == STATUS_FAILED) {
+            Serial.println(F("Failed to read orb information"));
             return STATUS_FAILED;
         }
-        orbInfo.stations[i].visited = page_buffer[0] == 1;
-        orbInfo.stations[i].custom = page_buffer[1];
-    }
-
-    // Read trait
-    if (readPage(TRAIT_PAGE) == STATUS_FAILED) {
-        Serial.println(F("Failed to read trait"));
-        return STATUS_FAILED;
-    }
-    orbInfo.trait = static_cast<TraitId>(page_buffer[0]);
-
-    // Read energy
-    if (readPage(ENERGY_PAGE) == STATUS_FAILED) {
-        Serial.println(F("Failed to read energy"));
-        return STATUS_FAILED;
+        uint8_t* data = block + (index % NTAG_READ_PAGES) * 4;
+        if (page == TRAIT_PAGE) {
+            orbInfo.trait = static_cast<TraitId>(data[0]);
+        } else if (page == ENERGY_PAGE) {
+            orbInfo.energy = data[0];
+        } else if (page >= STATIONS_PAGE_OFFSET) {
+            orbInfo.stations[page - STATIONS_PAGE_OFFSET].visited = data[0] == 1;
+            orbInfo.stations[page - STATIONS_PAGE_OFFSET].custom = data[1];
+        }
     }
-    orbInfo.energy = page_buffer[0];
 
     printOrbInfo();
     return STATUS_SUCCEEDED;
@@ -459,283 +1050,179 @@ int OrbDock::writeOrbInfo() {
 
 // Write station data
 int OrbDock::writeStations() {
+    uint8_t pages[NUM_STATIONS * 4];
+    memset(pages, 0, sizeof(pages));
     for (int i = 0; i < NUM_STATIONS; i++) {
-        if (writeStation(i) == STATUS_FAILED) {
-            return STATUS_FAILED;
-        }
+        pages[i * 4] = orbInfo.stations[i].visited ? 1 : 0;
+        pages[i * 4 + 1] = orbInfo.stations[i].custom;
+    }
+    if (writePages(STATIONS_PAGE_OFFSET, pages, NUM_STATIONS) == STATUS_FAILED) {
+        Serial.println(F("Failed to write stations"));
+        return STATUS_FAILED;
     }
     return STATUS_SUCCEEDED;
 }
 
-/********************** LED FUNCTIONS *****************************/
+void OrbDock::setNFCCheckInterval(uint16_t interval) {
+    nfcCheckInterval = interval;
+}
 
-void OrbDock::setLEDPattern(LEDPatternId patternId) {
-    ledPatternConfig = LED_PATTERNS[patternId];
+void OrbDock::rearmNFCDetection() {
+    lastNFCCheckTime = currentMillis - nfcCheckInterval;
 }
 
-void OrbDock::runLEDPatterns() {
-    static unsigned long ledPreviousMillis;
-    static uint8_t ledBrightness;
-    static unsigned int ledPatternInterval;
-    static LEDPatternId lastPatternId = LED_PATTERN_NO_ORB;
-    static byte lastEnergy = 0;  // Add this to track energy changes
-    const uint8_t MIN_INTERVAL = 10;
-    const uint8_t MAX_INTERVAL = 120;
+/********************** LED FUNCTIONS *****************************/
 
-    // Update the interval when pattern changes or energy changes (for ORB_CONNECTED pattern)
-    if (lastPatternId != ledPatternConfig.id || 
-        (ledPatternConfig.id == LED_PATTERN_ORB_CONNECTED && lastEnergy != orbInfo.energy)) {
-        
-        lastPatternId = static_cast<LEDPatternId>(ledPatternConfig.id);
-        lastEnergy = orbInfo.energy;
-        
-        if (ledPatternConfig.id == LED_PATTERN_ORB_CONNECTED) {
-            ledPatternInterval = constrain(
-                map(orbInfo.energy, 0, ALCHEMIZATION_ENERGY, MAX_INTERVAL, MIN_INTERVAL),
-                MIN_INTERVAL, MAX_INTERVAL
-            );
-        } else {
-            ledPatternInterval = ledPatternConfig.interval;
-        }
-    }
+void OrbDock::setLEDPattern(LEDPatternId patternId) {
+    ledPatternId = patternId;
+    ledPatternEnergy = 0xFF;
+    ringPattern.start(patternId);
+    // Ease from whatever the ring shows now into the new pattern
+    uint32_t fadeFrames = (uint32_t)ringPattern.getFadeTime() * ledFrames.getTargetFps() / 1000;
+    ringFade.start(min(fadeFrames, 255UL), ledEngine.getBrightness(LED_OUTPUT_RING));
+}
 
-    if (currentMillis - ledPreviousMillis >= ledPatternInterval) {
-        ledPreviousMillis = currentMillis;
+void OrbDock::setSerialFlowControl(bool enabled) {
+    serialLatch.setFlowControl(enabled);
+}
 
-        switch (ledPatternConfig.id) {
-            case LED_PATTERN_NO_ORB: {
-                led_rainbow();
-                break;
-            }
-            case LED_PATTERN_ORB_CONNECTED: {
-                if (orbInfo.energy == 0) {
-                    led_no_energy();
-                } else {
-                    led_trait_chase();
-                }
-                break;
-            }
-            case LED_PATTERN_FLASH: {
-                led_flash();
-                break;
-            }
-            case LED_PATTERN_ERROR: {
-                led_error();
-                break;
-            }
-            default:
-                break;
-        }
+void OrbDock::setLEDFrameRate(uint8_t fps) {
+    ledFrames.setTargetFps(fps);
+}
 
-        // Set brightness
-        if (ledBrightness != ledPatternConfig.brightness) {
-            ledBrightness = ledPatternConfig.brightness;
-            strip.setBrightness(ledBrightness);
-        }
-        // Smooth brightness transitions
-        // TODO: This causes a bunch of flickering jank. Figure out why.
-        // if (ledBrightness != ledPatternConfig.brightness && currentMillis - ledBrightnessPreviousMillis >= ledPatternConfig.brightnessInterval) {
-        //     ledBrightnessPreviousMillis = currentMillis;
-        //     ledBrightness = lerp(ledBrightness, ledPatternConfig.brightness, ledPatternConfig.brightnessInterval);
-        //     strip.setBrightness(ledBrightness);
-        // }
+void OrbDock::requestLEDFrame(uint8_t outputs) {
+    ledFrames.markDirty(outputs);
+}
 
-        strip.show();
+// Renders one frame per slot and only latches the outputs that changed
+void OrbDock::runLEDFrame() {
+    unsigned long now = micros();
+    if (ledFrames.frameDue(now)) {
+        ledFrames.beginRender();
+        ledFrames.markDirty(renderFrame());
+        ledFrames.endRender();
     }
 
-}
-
-// Rainbow cycle along whole strip. Pass delay time (in ms) between frames.
-void OrbDock::led_rainbow() {
-    static long firstPixelHue = 0;
-    if (firstPixelHue < 5*65536) {
-      strip.rainbow(firstPixelHue, 1, 255, 255, true);
-      firstPixelHue += 256;
+    // Dirty outputs latch as soon as serial input allows, which may be a few loops after the render
+    uint8_t outputs = ledFrames.getDirtyOutputs();
+    if (outputs && serialLatch.beginLatch(now)) {
+        unsigned long latchStart = micros();
+        ledFrames.beginLatch();
+        showFrame(outputs);
+        ledFrames.endLatch();
+        serialLatch.endLatch(micros() - latchStart);
     } else {
-      firstPixelHue = 0; // Reset for next cycle
+        serialLatch.poll(now);
     }
 }
 
-// Rotates a weakening dot around the NeoPixel ring using the trait color
-void OrbDock::led_trait_chase() {
-    static uint16_t currentPixel = 0;
-    static uint8_t intensity = 255;
-    static uint8_t globalIntensity = 0;
-    static int8_t globalDirection = 1;
-    static uint16_t hueOffset = 0;
-    static int8_t hueDirection = 1;
-    const uint16_t HUE_RANGE = 100; // Maximum hue shift in either direction
-    const uint8_t MIN_INTENSITY = 30;
-
-    // Update global intensity
-    globalIntensity += globalDirection * 9;  // Adjust 2 to change global fade speed
-    if (globalIntensity >= 255 || globalIntensity <= MIN_INTENSITY) {
-        globalDirection *= -1;
-        globalIntensity = constrain(globalIntensity, MIN_INTENSITY, 255);
-    }
+uint8_t OrbDock::renderFrame() {
+    return runLEDPatterns() ? LED_OUTPUT_RING : 0;
+}
 
-    // Update hue offset
-    hueOffset += hueDirection;
-    if (hueOffset >= HUE_RANGE || hueOffset <= 0) {
-        hueDirection *= -1;
-        hueOffset = constrain(hueOffset, 0, HUE_RANGE);
-    }
+void OrbDock::showFrame(uint8_t outputs) {
+    ledCanvas.beginOutput(outputs);
+    ledEngine.show(outputs);
+    ledCanvas.endOutput(outputs);
+}
 
-    // Find the trait color and apply hue shift
-    uint32_t baseColor = TRAIT_COLORS[static_cast<int>(orbInfo.trait)];
-    uint8_t r = (uint8_t)(baseColor >> 16);
-    uint8_t g = (uint8_t)(baseColor >> 8);
-    uint8_t b = (uint8_t)baseColor;
-    
-    // Simple hue shift by adjusting RGB values
-    float shift = (float)hueOffset / HUE_RANGE * 0.2; // Scale down shift effect
-    uint32_t traitColor = strip.Color(
-        constrain(r * (1 + shift), 0, 255),
-        constrain(g * (1 + shift), 0, 255),
-        constrain(b * (1 + shift), 0, 255)
-    );
-
-    // Calculate opposite pixel position
-    uint16_t oppositePixel = (currentPixel + (NEOPIXEL_COUNT / 2)) % NEOPIXEL_COUNT;
-    
-    // Set both bright dots
-    uint8_t adjustedIntensity = (uint16_t)intensity * globalIntensity / 255;
-    strip.setPixelColor(currentPixel, dimColor(traitColor, adjustedIntensity));
-    strip.setPixelColor(oppositePixel, dimColor(traitColor, adjustedIntensity));
-    
-    // Set pixels between the dots with decreasing intensity
-    for (int i = 1; i < NEOPIXEL_COUNT/2; i++) {
-        // Calculate pixels on both sides
-        uint16_t pixel1 = (currentPixel + i) % NEOPIXEL_COUNT;
-        uint16_t pixel2 = (currentPixel - i + NEOPIXEL_COUNT) % NEOPIXEL_COUNT;
-        
-        // Calculate fade based on distance to nearest bright dot
-        float fadeRatio = pow(float(NEOPIXEL_COUNT/4 - abs(i - NEOPIXEL_COUNT/4)) / (NEOPIXEL_COUNT/4), 2);
-        uint8_t fadeIntensity = round(intensity * fadeRatio);
-        adjustedIntensity = (uint16_t)fadeIntensity * globalIntensity / 255;
-        
-        if (adjustedIntensity > 0) {
-            strip.setPixelColor(pixel1, dimColor(traitColor, adjustedIntensity));
-            strip.setPixelColor(pixel2, dimColor(traitColor, adjustedIntensity));
-        }
-    }
-    
-    // Move to next pixel
-    currentPixel = (currentPixel + 1) % NEOPIXEL_COUNT;
-}
-
-void OrbDock::led_flash() {
-    static uint8_t intensity = 255;
-    static int8_t intensityDirection = -1;
-    static uint16_t hueOffset = 0;
-    static bool cycleComplete = false;
-
-    // If cycle is complete, switch to appropriate pattern
-    if (cycleComplete) {
-        intensity = 255;
-        intensityDirection = -1;
-        hueOffset = 0;
-        cycleComplete = false;
-        if (isOrbConnected) {
-            setLEDPattern(LED_PATTERN_ORB_CONNECTED);
-        } else {
-            setLEDPattern(LED_PATTERN_NO_ORB);
-        }
-        return;
-    }
+LedPatternFrame OrbDock::makeLEDFrame(CRGB* leds, uint16_t count) {
+    LedPatternFrame frame;
+    frame.leds = leds;
+    frame.count = count;
+    frame.lanes = 1;
+    frame.palette = &getTraitPalette();
+    frame.color = (*frame.palette)[TRAIT_PALETTE_CENTER / 16];
+    frame.energy = orbInfo.energy;
+    frame.now = currentMillis;
+    frame.steps = 0;
+    return frame;
+}
 
-    // Get base trait color and extract hue
-    uint32_t traitColor = TRAIT_COLORS[static_cast<int>(orbInfo.trait)];
-    uint8_t r = (uint8_t)(traitColor >> 16);
-    uint8_t g = (uint8_t)(traitColor >> 8); 
-    uint8_t b = (uint8_t)traitColor;
+LedPatternFrame OrbDock::makeLEDFrame(const LedCanvas& canvas) {
+    LedPatternFrame frame = makeLEDFrame(canvas.getPixels(), canvas.getSize());
+    frame.lanes = canvas.getSegmentCount();
+    return frame;
+}
 
-    // Fast fade intensity
-    intensity += intensityDirection * 12;
-    if (intensity <= 30 || intensity >= 255) {
-        intensityDirection *= -1;
-        intensity = constrain(intensity, 30, 255);
-        if (intensity <= 30) {
-            cycleComplete = true;
-        }
+// Loads the palette only when the trait changes, so renderers never derive colors per frame
+const CRGBPalette16& OrbDock::getTraitPalette() {
+    if (traitPaletteTrait != orbInfo.trait) {
+        traitPaletteTrait = orbInfo.trait;
+        loadTraitPalette(traitPalette, traitPaletteTrait);
     }
+    return traitPalette;
+}
 
-    // Rotate hue offset in opposite direction
-    hueOffset = (hueOffset - 8 + 360) % 360;
-
-    // Fill strip with hue-shifted colors
-    for (int i = 0; i < NEOPIXEL_COUNT; i++) {
-        // Calculate hue offset for this pixel
-        uint16_t pixelHue = (hueOffset + (360 * i / NEOPIXEL_COUNT)) % 360;
-        
-        // Create color with similar hue to trait color but varying
-        float hueShift = sin(pixelHue * PI / 180.0) * 30; // +/- 30 degree hue shift
-        uint32_t shiftedColor = strip.Color(
-            r + (r * hueShift/360),
-            g + (g * hueShift/360),
-            b + (b * hueShift/360)
-        );
+// Advances the ring pattern when a step is due; returns whether the ring changed
+bool OrbDock::runLEDPatterns() {
+    const uint8_t MIN_INTERVAL = 10;
+    const uint8_t MAX_INTERVAL = 120;
 
-        strip.setPixelColor(i, dimColor(shiftedColor, intensity));
+    // The orb pattern speeds up with the orb's energy
+    if (ledPatternId == LED_PATTERN_ORB_CONNECTED && ledPatternEnergy != orbInfo.energy) {
+        ledPatternEnergy = orbInfo.energy;
+        ringPattern.setInterval(constrain(
+            map(orbInfo.energy, 0, ALCHEMIZATION_ENERGY, MAX_INTERVAL, MIN_INTERVAL),
+            MIN_INTERVAL, MAX_INTERVAL
+        ));
     }
-}
 
-void OrbDock::led_no_energy() {
-    static uint8_t intensity = 0;
-    static int8_t direction = 1;
-    
-    // Slowly pulse intensity up and down
-    intensity += direction;
-    if (intensity >= 255 || intensity <= 0) {
-        direction *= -1;
-        intensity = constrain(intensity, 0, 255); 
+    LedPatternFrame frame = makeLEDFrame(ringCanvas, NEOPIXEL_COUNT);
+    uint8_t result = ringPattern.render(frame);
+    if (result == LED_FRAME_DONE) {
+        // One-shot patterns hand back to the orb's pattern, crossfading from their last frame
+        setLEDPattern(isOrbConnected ? LED_PATTERN_ORB_CONNECTED : LED_PATTERN_NO_ORB);
     }
-
-    // Set all pixels to dimmed red
-    for(int i = 0; i < NEOPIXEL_COUNT; i++) {
-        strip.setPixelColor(i, strip.Color(intensity, 0, 0));
+    if (result != LED_FRAME_CHANGED && !ringFade.isActive()) {
+        return false;
     }
-}
 
-void OrbDock::led_error() {
-    static uint8_t r = 0;
-    static uint8_t b = 255;
-    static bool toRed = true;
+    // The ring follows the canvas, and its brightness is applied when latching
+    ringFade.apply(ring, ringCanvas, NEOPIXEL_COUNT);
+    uint8_t ledBrightness = ringFade.getBrightness(ringPattern.getBrightness());
+    ledEngine.setBrightness(LED_OUTPUT_RING, ledBrightness);
 
-    if (toRed) {
-        r = min(255, r + 1);
-        b = max(0, b - 1);
-        if (r >= 255 && b <= 0) {
-            toRed = false;
-        }
-    } else {
-        r = max(0, r - 1); 
-        b = min(255, b + 1);
-        if (r <= 0 && b >= 255) {
-            toRed = true;
-        }
-    }
-
-    for(int i = 0; i < NEOPIXEL_COUNT; i++) {
-        strip.setPixelColor(i, r, 0, b);
+    // Track the ring's average output level for the power report
+    const uint8_t* pixels = ring[0].raw;
+    uint16_t level = 0;
+    for (int i = 0; i < NEOPIXEL_COUNT * 3; i++) {
+        level += pixels[i];
     }
+    powerStats.ledLevelSum += ((uint32_t)level * ledBrightness) >> 8;
+    powerStats.ledFrames++;
+    return true;
 }
 
-// Helper function to dim a 32-bit color value by a certain intensity (0-255)
-uint32_t OrbDock::dimColor(uint32_t color, uint8_t intensity) {
-  uint8_t r = (uint8_t)(color >> 16);
-  uint8_t g = (uint8_t)(color >> 8);
-  uint8_t b = (uint8_t)color;
-  
-  r = (r * intensity) >> 8;
-  g = (g * intensity) >> 8;
-  b = (b * intensity) >> 8;
-  
-  return strip.Color(r, g, b);
-}
+// Times each pattern kernel on a scratch ring, without latching, and prints the cost per frame
+void OrbDock::benchmarkLEDKernels() {
+    CRGB scratch[NEOPIXEL_COUNT];
+    LedPatternState state;
+    LEDPatternConfig pattern;
+
+    Serial.println(F("LED kernel benchmark (per frame):"));
+    for (uint8_t id = 0; id < LED_PATTERN_COUNT; id++) {
+        memcpy_P(&pattern, &LED_PATTERNS[id], sizeof(pattern));
+        memset(&state, 0, sizeof(state));
+        fill_solid(scratch, NEOPIXEL_COUNT, CRGB::Black);
+        LedPatternFrame frame = makeLEDFrame(scratch, NEOPIXEL_COUNT);
+        frame.energy = ALCHEMIZATION_ENERGY;
+        frame.steps = 1;
+
+        unsigned long start = micros();
+        for (int i = 0; i < LED_BENCHMARK_FRAMES; i++) {
+            frame.now += max(pattern.interval, (uint16_t)1);
+            pattern.render(frame, state);
+        }
+        unsigned long perFrame = (micros() - start) / LED_BENCHMARK_FRAMES;
 
-float OrbDock::lerp(float start, float end, float t) {
-    return start + t * (end - start);
+        Serial.print((const __FlashStringHelper*)pattern.name);
+        Serial.print(F(": "));
+        Serial.print(perFrame);
+        Serial.print(F(" us, "));
+        Serial.print(perFrame * clockCyclesPerMicrosecond());
+        Serial.println(F(" cycles"));
+    }
 }
 
 // Provide empty implementations for pure virtual functions to satisfy the linker
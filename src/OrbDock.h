@@ -4,7 +4,13 @@
 #include <Wire.h>
 #include <SPI.h>
 #include <Adafruit_PN532.h>
-#include <Adafruit_NeoPixel.h>
+#include "LedEngine.h"
+#include "LedFrameScheduler.h"
+#include "LedPatterns.h"
+#include "LedCrossfade.h"
+#include "LedCanvas.h"
+#include "TraitPalette.h"
+#include "SerialLatchGuard.h"
 
 // NeoPixel pin 
 #define NEOPIXEL_PIN (6)
@@ -27,6 +33,15 @@
 #define PN532_MOSI1 (3)
 #define PN532_SS1   (4)
 
+// PN532 pin sets to try, in order: SCK, MISO, MOSI, SS
+#define PN532_PIN_SET_COUNT 3
+#define PN532_PIN_SET_UNKNOWN 0xFF
+const uint8_t PN532_PIN_SETS[PN532_PIN_SET_COUNT][4] = {
+    {PN532_SCK,  PN532_MISO,  PN532_MOSI,  PN532_SS},   // Latest design
+    {PN532_SCK2, PN532_MISO2, PN532_MOSI2, PN532_SS2},  // V2
+    {PN532_SCK1, PN532_MISO1, PN532_MOSI1, PN532_SS1}   // V1
+};
+
 // Status constants
 #define STATUS_FAILED    0
 #define STATUS_SUCCEEDED 1
@@ -39,6 +54,29 @@
 #define NFC_TIMEOUT      1000
 #define DELAY_AFTER_CARD_PRESENT 50
 #define NFC_CHECK_INTERVAL 300
+#define NFC_FAILURE_THRESHOLD 3          // Consecutive failed transactions before probing the PN532
+#define NFC_HEALTH_CHECK_INTERVAL 5000   // How often to probe the PN532 while no NFC is present
+#define NFC_RECOVERY_INTERVAL 1000       // Time between recovery attempts
+#define NFC_SAM_RECOVERY_ATTEMPTS 2      // Recovery attempts that only re-run SAMConfig before a full re-init
+#define NFC_VERIFY_WRITES true           // Read back written pages and rewrite the ones that didn't take
+#define NFC_USE_AUTOPOLL true            // Let the PN532 hunt for tags with InAutoPoll instead of polling from loop()
+#define NFC_AUTOPOLL_PERIOD 1            // InAutoPoll period, in units of 150 ms
+#define NFC_AUTOPOLL_TYPE 0x00           // Generic passive 106 kbps (ISO/IEC14443A)
+#define NFC_AUTOPOLL_READY_INTERVAL 5    // How often to check whether InAutoPoll found a target
+#define NFC_RESPONSE_TIMEOUT 100
+#define NFC_POWERDOWN_WAKEUP 0x28        // Wake the PN532 from PowerDown on SPI traffic or an external RF field
+
+// Low power idle
+#define IDLE_TIMEOUT 30000               // Quiet period before going idle (0 disables idle mode)
+#define IDLE_NFC_CHECK_INTERVAL 1000     // NFC check interval while idle; the PN532 is powered down in between
+
+// Current estimates in uA, used for the power report
+#define POWER_REPORT_INTERVAL 60000
+#define CURRENT_MCU_ACTIVE 15000
+#define CURRENT_MCU_SLEEP 6000
+#define CURRENT_NFC_ACTIVE 110000
+#define CURRENT_NFC_POWERDOWN 2000
+#define CURRENT_LED_CHANNEL 20000        // Per fully lit LED channel
 
 // NFC constants
 #define PAGE_OFFSET 4
@@ -46,10 +84,32 @@
 #define TRAIT_PAGE (PAGE_OFFSET + 1) 
 #define ENERGY_PAGE (PAGE_OFFSET + 2)
 #define STATIONS_PAGE_OFFSET (PAGE_OFFSET + 3)
+#define ORB_PAGE_COUNT (STATIONS_PAGE_OFFSET + NUM_STATIONS - ORBS_PAGE)  // Pages written by formatNFC
 #define ORBS_HEADER "ORBS"
+#define NFC_UID_LENGTH 7
+#define NFC_PAGE_COUNT 45         // NTAG203/213: pages 0..44
+#define NFC_USER_PAGE_LAST 39     // Pages after this are lock/config and are never restored
+#define NTAG_CMD_READ 0x30        // NTAG READ returns 4 consecutive pages per transaction
+#define NTAG_READ_PAGES 4
+#define NTAG_READ_BYTES (NTAG_READ_PAGES * 4)
+
+// Orb image format, streamed by the snapshot command and accepted by the restore command:
+//   "ORBI" | version | UID length | UID (7) | first page | page count | pages (count * 4) | CRC-16 (big endian)
+// The CRC (see Crc16.h) covers every byte before it.
+#define ORB_IMAGE_MAGIC "ORBI"
+#define ORB_IMAGE_VERSION 1
+#define ORB_IMAGE_HEADER_SIZE 15
+
+// Serial commands
+#define SERIAL_CMD_SNAPSHOT 'S'   // Stream an image of the connected tag
+#define SERIAL_CMD_RESTORE  'R'   // Followed by an image; writes back the pages that differ
+#define SERIAL_CMD_BENCHMARK 'B'  // Time each LED pattern kernel
+#define SERIAL_CMD_FRAME_STATS 'F' // Print LED frame budget and serial latch statistics
 
 // LED constants
 #define NEOPIXEL_COUNT  24
+#define LED_BENCHMARK_FRAMES 100
+#define LED_TARGET_FPS 60
 
 // Orb constants
 #define NUM_STATIONS 14
@@ -71,15 +131,7 @@ const char* const TRAIT_NAMES[] = {
     "HOPELESS"
 };
 
-const uint32_t TRAIT_COLORS[] = {
-    0xFF0000,  // None
-    0xFF2800,  // Orange for RUMINATE (Rumination)
-    0xFF6000,  // Yellow for SHAME (Shame Spiral)
-    0x20FF00,  // Green for DOUBT (Self Doubt)
-    0xFF00D2,  // Pink/Magenta for DISCONTENT (Discontentment)
-    0x1400FF   // Blue for HOPELESS (Hopelessness)
-};
-
+// Trait colors are the centers of the trait palettes in TraitPalette.cpp
 const char* const TRAIT_COLOR_NAMES[] = {
     "red",     // None
     "orange",  // Rumination
@@ -107,54 +159,6 @@ struct Station {
     byte custom;
 };
 
-enum LEDPatternId {
-    LED_PATTERN_NO_ORB,
-    LED_PATTERN_ORB_CONNECTED,
-    LED_PATTERN_FLASH,
-    LED_PATTERN_ERROR,
-    LED_PATTERN_NO_ENERGY
-};
-
-struct LEDPatternConfig {
-    int id;
-    uint8_t brightness;
-    uint16_t interval;
-    float brightnessInterval;
-};
-
-const LEDPatternConfig LED_PATTERNS[] = {
-    {
-        .id = LED_PATTERN_NO_ORB,
-        .brightness = 200,
-        .interval = 15,
-        .brightnessInterval = 5.0f
-    },
-    {
-        .id = LED_PATTERN_ORB_CONNECTED,
-        .brightness = 255,
-        .interval = 80,
-        .brightnessInterval = 5.0f
-    },
-    {
-        .id = LED_PATTERN_FLASH,
-        .brightness = 255,
-        .interval = 10,
-        .brightnessInterval = 5.0f
-    },
-    {
-        .id = LED_PATTERN_ERROR,
-        .brightness = 255,
-        .interval = 5,
-        .brightnessInterval = 5.0f,
-    },
-    {
-        .id = LED_PATTERN_NO_ENERGY,
-        .brightness = 100,
-        .interval = 200,
-        .brightnessInterval = 10.0f
-    }
-};
-
 // Additional helper structs/enums
 struct OrbInfo {
     TraitId trait;
@@ -162,6 +166,28 @@ struct OrbInfo {
     Station stations[NUM_STATIONS];
 };
 
+// PN532 health monitoring
+struct NFCHealth {
+    bool healthy;
+    uint8_t consecutiveFailures;
+    uint8_t recoveryAttempts;
+    unsigned long downSince;
+    unsigned long lastCheck;
+    unsigned long lastRecoveryAttempt;
+    uint16_t recoveries;
+    unsigned long totalRecoveryTime;
+};
+
+// Duty cycle accounting for the power report
+struct PowerStats {
+    unsigned long windowStart;
+    unsigned long mcuSleepMicros;
+    unsigned long nfcAwakeMillis;
+    unsigned long nfcAwakeSince;
+    uint32_t ledLevelSum;
+    uint16_t ledFrames;
+};
+
 class OrbDock {
 public:
     OrbDock(StationId id);
@@ -177,9 +203,21 @@ protected:
     bool isNFCConnected;
     bool isOrbConnected;
     bool isUnformattedNFC;
+    uint8_t nfcUid[NFC_UID_LENGTH];
     
     // Timing variables
     unsigned long currentMillis;
+    unsigned long lastNFCCheckTime;
+    uint16_t nfcCheckInterval;
+
+    // NFC
+    bool verifyWrites;
+    bool useAutoPoll;
+
+    // Low power idle
+    bool isIdle;
+    unsigned long lastNFCActivity;
+    uint32_t idleTimeout;
 
     // Virtual methods for child classes to implement
     virtual void onOrbConnected() = 0;
@@ -187,6 +225,27 @@ protected:
     virtual void onError(const char* errorMessage) = 0;
     virtual void onUnformattedNFC() = 0;
     virtual void onEnergyLevelChanged(byte newEnergy) {};
+    // Lets a dock claim bytes of its own serial protocol before they are taken as commands
+    virtual bool onSerialByte(uint8_t data) { return false; }
+
+    // LED frame hooks, called by the frame scheduler once per frame slot.
+    // renderFrame() returns the outputs (LED_OUTPUT_*) it changed; showFrame() latches the dirty ones.
+    // Docks with their own strips lay them out on ledCanvas, register them with ledEngine and
+    // override renderFrame(), calling the base version for the ring. showFrame() puts the canvas
+    // into physical order around the latch.
+    virtual uint8_t renderFrame();
+    virtual void showFrame(uint8_t outputs);
+
+    // Drives the ring and any station strips
+    LedEngine ledEngine;
+    // The station strips as one logical strip; empty on docks without any
+    LedCanvas ledCanvas;
+    // Fills in a pattern frame for a buffer with the current orb and time
+    LedPatternFrame makeLEDFrame(CRGB* leds, uint16_t count);
+    // The same for the whole canvas, one lane per segment
+    LedPatternFrame makeLEDFrame(const LedCanvas& canvas);
+    // The current orb's trait palette (see TraitPalette.h); index TRAIT_PALETTE_CENTER is its trait color
+    const CRGBPalette16& getTraitPalette();
 
     // Helper methods that child classes can use
     Station getCurrentStationInfo();
@@ -208,17 +267,60 @@ protected:
     int setVisited(bool visited);
     // Sets the custom value of the current station
     int setCustom(byte value);
+    // Sets the quiet period before going into low power idle (0 disables idle mode)
+    void setIdleTimeout(uint32_t timeout);
+    // Detects tags with the PN532's InAutoPoll instead of polling from loop() (defaults to NFC_USE_AUTOPOLL)
+    void setAutoPoll(bool enabled);
+    // Enables or disables read-after-write verification (defaults to NFC_VERIFY_WRITES)
+    void setWriteVerification(bool enabled);
+    // Sets how often to check for NFC presence (defaults to NFC_CHECK_INTERVAL)
+    void setNFCCheckInterval(uint16_t interval);
+    // Checks for NFC presence on the next loop instead of waiting for the check interval
+    void rearmNFCDetection();
     // Sets the LED pattern
     void setLEDPattern(LEDPatternId patternId);
+    // Sets the LED frame rate (defaults to LED_TARGET_FPS)
+    void setLEDFrameRate(uint8_t fps);
+    // Latches the given outputs on the next frame, for changes made outside renderFrame()
+    void requestLEDFrame(uint8_t outputs);
+    // Pauses the host with XON/XOFF around LED latches that can't wait for a quiet line (off by default;
+    // the host must honour XON/XOFF and the dock then can't send binary replies, see SerialLatchGuard.h)
+    void setSerialFlowControl(bool enabled);
     // Reads and prints the entire NFC storage
     void printNFCStorage();
 
 private:
+    // NFC health methods
+    bool initNFC(uint8_t pinSet);
+    bool monitorNFC();
+    void recordNFCFailure();
+    void markNFCDown();
+
+    // Low power methods
+    void enterIdle();
+    void exitIdle();
+    bool wakeNFC();
+    void powerDownNFC();
+    void sleepCPU();
+    void reportPower();
+
+    // Raw PN532 SPI access for commands Adafruit_PN532 doesn't wrap
+    uint8_t nfcTransfer(uint8_t data);
+    bool isNFCResponseReady();
+    bool waitNFCResponse(uint16_t timeout);
+    int readNFCResponse(uint8_t* response, uint8_t maxLength);
+    int nfcDataExchange(const uint8_t* send, uint8_t sendLength, uint8_t* response, uint8_t maxLength);
+    bool checkAutoPoll();
+    void abortAutoPoll();
+
     // NFC helper methods
     int writeStation(int stationID);
     int writeStations();
     int writePage(int page, uint8_t* data);
     int readPage(int page);
+    int readPages(int page, uint8_t* buffer);
+    int writePages(int startPage, const uint8_t* data, int count, int* pagesWritten = nullptr);
+    uint8_t mismatchedPages(const uint8_t* block, const uint8_t* expected, int count);
     int readOrbInfo();
     int writeOrbInfo();
     void reInitializeStations();
@@ -229,27 +331,40 @@ private:
     void endOrbSession();
 
     // LED pattern methods
-    void runLEDPatterns();
-    void led_rainbow();
-    void led_trait_chase();
-    void led_flash();
-    void led_error();
-    void led_no_energy();
-    uint32_t dimColor(uint32_t color, uint8_t intensity);
-    float lerp(float start, float end, float t);
+    void runLEDFrame();
+    bool runLEDPatterns();
+    void benchmarkLEDKernels();
+
+    // Serial command methods
+    void handleSerialCommands();
+    void snapshotNFC();
+    void restoreNFC();
 
     // Additional helper methods
     void handleError(const char* message);
     
     // Hardware objects
-    Adafruit_NeoPixel strip;
-    Adafruit_PN532 nfc;
+    CRGB ring[NEOPIXEL_COUNT];          // What the ring shows
+    CRGB ringCanvas[NEOPIXEL_COUNT];    // What the ring pattern draws; ring crossfades to it
+    Adafruit_PN532* nfc;                // One of the pin sets' drivers
     
     // LED variables
-    LEDPatternConfig ledPatternConfig;
+    LedPatternEngine ringPattern;
+    LedCrossfade ringFade;
+    LEDPatternId ledPatternId;
+    uint8_t ledPatternEnergy;   // Energy the orb pattern's speed was last set for
+    CRGBPalette16 traitPalette;
+    uint8_t traitPaletteTrait;  // Trait traitPalette was loaded for
+    LedFrameScheduler ledFrames;
+    SerialLatchGuard serialLatch;
     
     // NFC
     byte page_buffer[4];
+    uint8_t nfcPinSet;
+    NFCHealth nfcHealth;
+    bool nfcPoweredDown;
+    bool autoPollArmed;
+    PowerStats powerStats;
 };
 
 #endif
@@ -6,10 +6,10 @@
  *  SDA: A4 (Pin 27)
  *  SCL: A5 (Pin 28)
  * Button Pins:
- *  S1: D8     // Add 1 energy
- *  S2: D9     // Add 5 energy  
- *  S3: D10    // Remove 1 energy
- *  S4: D11    // Remove 5 energy
+ *  S1: D7     // Add 1 energy
+ *  S2: D8     // Add 5 energy  
+ *  S3: D9     // Remove 5 energy
+ *  S4: D10    // Remove 1 energy
  * 
  *  * orbInfo contains information on connected orb:
  * - trait (byte, one of TraitId enum)
@@ -32,17 +32,53 @@
 #include "OrbDock.h"
 #include "ButtonDisplay.h"
 
+// Energy changes from held buttons are written to the orb at most this often, and on release
+#define CASINO_ENERGY_WRITE_INTERVAL 1000
+
+// Energy per press or repeat of each button
+static const int8_t CASINO_BUTTON_ENERGY[BUTTON_COUNT] = { 1, 5, -5, -1 };
+
 class OrbDockCasino : public OrbDock {
 private:
     const uint8_t* font = u8g_font_fub49n;
     ButtonDisplay display{font};
+    int16_t pendingEnergy;      // Button changes not yet written to the orb
+    unsigned long lastEnergyWrite;
+
+    // Energy including the changes not yet written
+    uint8_t getDisplayedEnergy() {
+        return constrain(orbInfo.energy + pendingEnergy, 0, MAX_ENERGY);
+    }
+
+    // Writes the accumulated button changes in one NFC write
+    void writePendingEnergy() {
+        if (pendingEnergy != 0) {
+            uint8_t energy = getDisplayedEnergy();
+            pendingEnergy = 0;
+            setEnergy(energy);
+        }
+        lastEnergyWrite = millis();
+    }
+
+    void handleButton(const ButtonEvent& event) {
+        if (event.type == BUTTON_RELEASED) {
+            writePendingEnergy();
+            return;
+        }
+        if (pendingEnergy == 0) {
+            lastEnergyWrite = millis();   // The rate limit runs from the first change
+        }
+        pendingEnergy += CASINO_BUTTON_ENERGY[event.button];
+        pendingEnergy = getDisplayedEnergy() - orbInfo.energy;   // Stop at empty and full
+        updateDisplay();
+    }
 
     void updateDisplay() {
         display.clearDisplay();
         
         if (isOrbConnected) {
             char energyStr[8];
-            itoa(orbInfo.energy, energyStr, 10);
+            itoa(getDisplayedEnergy(), energyStr, 10);
             display.println(energyStr);
         } else {
             display.println("::");
@@ -53,6 +89,8 @@ private:
 
 public:
     OrbDockCasino() : OrbDock(StationId::CASINO) {
+        pendingEnergy = 0;
+        lastEnergyWrite = 0;
     }
 
     void begin() {
@@ -63,28 +101,19 @@ public:
 
     void loop() override {
         OrbDock::loop();
+        display.tick();
 
-        if (!isOrbConnected) return;
-
-        // Handle button inputs
-        if (display.isButton1Pressed()) {
-            addEnergy(1);
-            updateDisplay();
-        }
-        
-        if (display.isButton2Pressed()) {
-            addEnergy(5);
-            updateDisplay();
-        }
-
-        if (display.isButton3Pressed()) {
-            removeEnergy(5);
-            updateDisplay();
+        // Handle button inputs; presses without an orb are dropped
+        ButtonEvent event;
+        while (display.pollButton(event)) {
+            if (isOrbConnected) {
+                handleButton(event);
+            }
         }
 
-        if (display.isButton4Pressed()) {
-            removeEnergy(1);
-            updateDisplay();
+        // Write a held button's changes now and then rather than on every repeat
+        if (pendingEnergy != 0 && millis() - lastEnergyWrite >= CASINO_ENERGY_WRITE_INTERVAL) {
+            writePendingEnergy();
         }
     }
 
@@ -98,18 +127,17 @@ protected:
     }
 
     void onOrbDisconnected() override {
+        pendingEnergy = 0;   // The orb left before it could be written
         updateDisplay();
     }
 
     void onError(const char* errorMessage) override {
         display.showError(errorMessage);
-        delay(2000);
         updateDisplay();
     }
 
     void onUnformattedNFC() override {
         display.showError(":::::");
-        delay(2000);
         updateDisplay();
     }
 };
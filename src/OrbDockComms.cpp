@@ -1,6 +1,12 @@
 #include "OrbDockComms.h"
+#include "PinChange.h"
 #include <Arduino.h>
 
+volatile bool OrbDockComms::_clearEnergyLatched = false;
+volatile uint8_t* OrbDockComms::_clearEnergyPort = nullptr;
+uint8_t OrbDockComms::_clearEnergyMask = 0;
+bool OrbDockComms::_clearEnergyLevel = false;
+
 OrbDockComms::OrbDockComms(uint8_t orbPresentPin, uint8_t energyLevelPin, uint8_t toxicTraitPin, uint8_t clearEnergyPin)
     : OrbDock(StationId::GENERIC),
     _orbPresentPin(orbPresentPin),
@@ -22,25 +28,98 @@ void OrbDockComms::begin() {
     pinMode(_toxicTraitPin, OUTPUT);
     
     digitalWrite(_clearEnergyPin, LOW);  // switch on pull down
+    _clearEnergyPort = portInputRegister(digitalPinToPort(_clearEnergyPin));
+    _clearEnergyMask = digitalPinToBitMask(_clearEnergyPin);
+    _clearEnergyLevel = *_clearEnergyPort & _clearEnergyMask;
+    if (!attachPinChange(_clearEnergyPin, onClearEnergyChange)) {
+        Serial.println(F("No pin change interrupt for clear energy"));
+    }
     digitalWrite(_orbPresentPin, LOW);
-    analogWrite(_energyLevelPin, 0);
-    analogWrite(_toxicTraitPin, 0);
+#if COMMS_FAST_PWM
+    beginFastPWM();
+#endif
+    writeLevel(_energyLevelPin, 0);
+    writeLevel(_toxicTraitPin, 0);
 }
 
 void OrbDockComms::loop() {
     OrbDock::loop();
+    _link.poll(millis());
+
+    // One clear per pulse, however long the line is held high
+    if (_clearEnergyLatched) {
+        _clearEnergyLatched = false;
+        if (isOrbConnected) {
+            Serial.println(F("Orb Comms clearing energy"));
+            applyEnergy(0);
+        }
+    }
+
+    CommsCommand command;
+    if (_link.takeCommand(command)) {
+        _link.finishCommand(runCommand(command));
+    }
+}
 
-    if (digitalRead(_clearEnergyPin) == HIGH && isOrbConnected) {
-        Serial.println(F("Orb Comms clearing energy"));
-        setEnergy(0);
+// Latches rising edges. The handler reads the line after the edge, so pulses must outlast the
+// interrupt latency, a few microseconds.
+void OrbDockComms::onClearEnergyChange() {
+    bool level = *_clearEnergyPort & _clearEnergyMask;
+    if (level && !_clearEnergyLevel) {
+        _clearEnergyLatched = true;
     }
+    _clearEnergyLevel = level;
+}
+
+// Commands are idempotent at the orb: one that wouldn't change it writes nothing. Returns false
+// if it didn't take, so the controller isn't acknowledged and resends it.
+bool OrbDockComms::runCommand(const CommsCommand& command) {
+    if (!isOrbConnected) {
+        Serial.println(F("Orb Comms command without an orb"));
+        return false;
+    }
+    switch (command.type) {
+        case COMMS_CMD_SET_ENERGY:
+            return applyEnergy(min(command.value, MAX_ENERGY));
+        case COMMS_CMD_ADD_ENERGY:
+            return applyEnergy(constrain(orbInfo.energy + (int8_t)command.value, 0, MAX_ENERGY));
+        case COMMS_CMD_SET_TRAIT:
+            if (command.value >= NUM_TRAITS) {
+                return false;
+            }
+            if (command.value == orbInfo.trait) {
+                return true;
+            }
+            if (setTrait(static_cast<TraitId>(command.value)) != STATUS_SUCCEEDED) {
+                return false;
+            }
+            writeLevel(_toxicTraitPin, traitToInt(orbInfo.trait));
+            sendEvent(COMMS_FRAME_TRAIT);
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Sets the orb's energy unless it already has it, then updates the pin and the controller.
+// Returns false if the write failed.
+bool OrbDockComms::applyEnergy(uint8_t energy) {
+    if (energy == orbInfo.energy) {
+        return true;
+    }
+    if (setEnergy(energy) != STATUS_SUCCEEDED) {
+        return false;
+    }
+    onEnergyLevelChanged(energy);
+    return true;
 }
 
 void OrbDockComms::onOrbConnected() {
     OrbDock::onOrbConnected();
     digitalWrite(_orbPresentPin, HIGH);
-    analogWrite(_energyLevelPin, orbInfo.energy);
-    analogWrite(_toxicTraitPin, traitToInt(orbInfo.trait));
+    writeLevel(_energyLevelPin, orbInfo.energy);
+    writeLevel(_toxicTraitPin, traitToInt(orbInfo.trait));
+    sendEvent(COMMS_FRAME_CONNECT);
     // Serial.println(F("Orb Comms orb connected"));
     // Serial.print(F("Energy: "));
     // Serial.println(orbInfo.energy);
@@ -51,13 +130,15 @@ void OrbDockComms::onOrbConnected() {
 void OrbDockComms::onOrbDisconnected() {
     OrbDock::onOrbDisconnected();
     digitalWrite(_orbPresentPin, LOW);
-    analogWrite(_energyLevelPin, 0);
-    analogWrite(_toxicTraitPin, 0);
+    writeLevel(_energyLevelPin, 0);
+    writeLevel(_toxicTraitPin, 0);
+    sendEvent(COMMS_FRAME_DISCONNECT);
     Serial.println(F("Orb Comms orb disconnected"));
 }
 
 void OrbDockComms::onEnergyLevelChanged(byte newEnergy) {
-    analogWrite(_energyLevelPin, newEnergy);
+    writeLevel(_energyLevelPin, newEnergy);
+    sendEvent(COMMS_FRAME_ENERGY);
 }
 
 void OrbDockComms::onError(const char* errorMessage) {
@@ -73,6 +154,65 @@ void OrbDockComms::onUnformattedNFC() {
     onOrbConnected();
 }
 
+// Takes ACKs from the controller; the frame stats command reports the link too
+bool OrbDockComms::onSerialByte(uint8_t data) {
+    if (_link.receive(data)) {
+        return true;
+    }
+    if (data == SERIAL_CMD_FRAME_STATS) {
+        _link.printStats();
+    }
+    return false;
+}
+
+// The orb as it is now; after a disconnect only the UID still describes it
+void OrbDockComms::sendEvent(uint8_t type) {
+    CommsEvent event;
+    event.type = type;
+    event.micros = micros();
+    memcpy(event.uid, nfcUid, COMMS_UID_LENGTH);
+    event.trait = orbInfo.trait;
+    event.energy = orbInfo.energy;
+    event.stations = 0;
+    for (uint8_t i = 0; i < NUM_STATIONS; i++) {
+        if (orbInfo.stations[i].visited) {
+            event.stations |= _BV(i);
+        }
+    }
+    _link.send(event);
+    _link.poll(millis());   // Out now rather than on the next loop
+}
+
+// Fast PWM with no prescaler on the timers behind the PWM pins other than 5 and 6: 8-bit, so
+// 16MHz / 256 = 62.5kHz. Timer0 is left alone, as it drives millis() and the button tick (see
+// ButtonInput.h); FastLED's clockless output bit-bangs without a timer. Nothing else here uses
+// Timer1 or Timer2, but tone() and the Servo library would no longer work.
+void OrbDockComms::beginFastPWM() {
+    // Timer1 (pins 9, 10): mode 5, 8-bit fast PWM
+    TCCR1A = _BV(WGM10);
+    TCCR1B = _BV(WGM12) | _BV(CS10);
+    // Timer2 (pins 3, 11): mode 3, fast PWM
+    TCCR2A = _BV(WGM21) | _BV(WGM20);
+    TCCR2B = _BV(CS20);
+}
+
+// analogWrite() with the fast timers: the compare output is connected on each write, because
+// analogWrite() and digitalWrite() disconnect it for 0 (fast PWM would still pulse at 0)
+void OrbDockComms::writeLevel(uint8_t pin, uint8_t value) {
+#if COMMS_FAST_PWM
+    if (value > 0) {
+        switch (digitalPinToTimer(pin)) {
+            case TIMER1A: OCR1A = value; TCCR1A |= _BV(COM1A1); return;
+            case TIMER1B: OCR1B = value; TCCR1A |= _BV(COM1B1); return;
+            case TIMER2A: OCR2A = value; TCCR2A |= _BV(COM2A1); return;
+            case TIMER2B: OCR2B = value; TCCR2A |= _BV(COM2B1); return;
+            default: break;
+        }
+    }
+#endif
+    analogWrite(pin, value);
+}
+
 uint8_t OrbDockComms::traitToInt(TraitId trait) {
     switch (trait) {
         case NONE:       return 25;
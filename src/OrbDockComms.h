@@ -2,17 +2,39 @@
 #define ORBDOCKCOMMS_H
 
 #include "OrbDock.h"
+#include "CommsLink.h"
+
+// 1 runs the analog outputs at a 62.5kHz PWM carrier instead of analogWrite()'s 490Hz (pins 9 and 11
+// are on Timer1 and Timer2; only pins 5 and 6 on Timer0 run at 980Hz). That is about 128x faster, so a
+// controller's RC filter can be that much quicker for the same ripple. Duty is still value/255 to within
+// one step, so controllers decode it as before. Takes over Timer1 and Timer2 (see beginFastPWM()).
+#define COMMS_FAST_PWM 0
 
 class OrbDockComms : public OrbDock {
 private:
     static uint8_t traitToInt(TraitId trait);
     static TraitId intToTrait(uint8_t value);
+    static void beginFastPWM();
+    static void writeLevel(uint8_t pin, uint8_t value);
 
     uint8_t _orbPresentPin;
     uint8_t _energyLevelPin;
     uint8_t _toxicTraitPin;
     uint8_t _clearEnergyPin;
 
+    // Framed events to the controller, alongside the pins, and its commands
+    CommsLink _link;
+    void sendEvent(uint8_t type);
+    bool runCommand(const CommsCommand& command);
+    bool applyEnergy(uint8_t energy);
+
+    // The clear energy input, latched on its rising edge by a pin change interrupt (see PinChange.h)
+    static volatile bool _clearEnergyLatched;
+    static volatile uint8_t* _clearEnergyPort;
+    static uint8_t _clearEnergyMask;
+    static bool _clearEnergyLevel;
+    static void onClearEnergyChange();
+
 public:
     OrbDockComms(uint8_t orbPresentPin = 10, uint8_t energyLevelPin = 11, uint8_t toxicTraitPin = 9, uint8_t clearEnergyPin = 13);
     void begin() override;
@@ -24,6 +46,7 @@ protected:
     void onEnergyLevelChanged(byte newEnergy) override;
     void onError(const char* errorMessage) override;
     void onUnformattedNFC() override;
+    bool onSerialByte(uint8_t data) override;
 };
 
 #endif // ORBDOCKCOMMS_H
\ No newline at end of file
@@ -6,10 +6,15 @@
  *  SDA: A4 (Pin 27)
  *  SCL: A5 (Pin 28)
  * Button Pins:
- *  S1: D8     // Add 1 energy
- *  S2: D9     // Add 5 energy  
- *  S3: D10    // Remove 1 energy
- *  S4: D11    // Remove 5 energy
+ *  S1: D7     // Next trait
+ *  S2: D8     // Previous trait
+ *  S3: D9     // Format orb (provisioning mode without one)
+ *  S4: D10    // Reset orb
+ *
+ * Provisioning mode (toggle with S3 while no orb is on the dock):
+ *  Every tag placed is formatted with the selected trait straight away, pages that are
+ *  already correct are skipped, and detection re-arms for the next tag. The display shows
+ *  orbs/minute and the failure count.
  * 
  *  * orbInfo contains information on connected orb:
  * - trait (byte, one of TraitId enum)
@@ -33,6 +38,8 @@
 #include "OrbDock.h"
 #include "ButtonDisplay.h"
 
+#define PROVISION_CHECK_INTERVAL 50   // NFC check interval while provisioning
+
 class OrbDockConfigurizer : public OrbDock {
 private:
 
@@ -42,10 +49,28 @@ private:
     ButtonDisplay display{font};
     TraitId selectedTrait;
 
+    // Provisioning mode
+    bool provisioning;
+    uint16_t provisionedCount;
+    uint16_t provisionFailures;
+    unsigned long lastProvisionTime;
+    unsigned long provisionInterval;  // Smoothed time between orbs, in ms
+
     void updateDisplay() {
         display.clearDisplay();
         
-        if (isOrbConnected) {
+        if (provisioning) {
+            char shortName[9];
+            strncpy(shortName, TRAIT_NAMES[selectedTrait], 8);
+            shortName[8] = '\0';
+            display.println(shortName);
+            char stats[16];
+            unsigned int perMinute = provisionInterval > 0 ? 60000UL / provisionInterval : 0;
+            utoa(perMinute, stats, 10);
+            strcat(stats, "/m F");
+            utoa(provisionFailures, stats + strlen(stats), 10);
+            display.println(stats);
+        } else if (isOrbConnected) {
             char shortName[9];
             strncpy(shortName, TRAIT_NAMES[selectedTrait], 8);
             shortName[8] = '\0';
@@ -65,6 +90,11 @@ private:
 public:
     OrbDockConfigurizer() : OrbDock(StationId::CONFIGURE) {
         selectedTrait = TraitId::RUMINATE;
+        provisioning = false;
+        provisionedCount = 0;
+        provisionFailures = 0;
+        lastProvisionTime = 0;
+        provisionInterval = 0;
     }
 
     void begin() {
@@ -75,50 +105,99 @@ public:
 
     void loop() override {
         OrbDock::loop();
+        display.tick();
+
+        // Handle button inputs: trait selection repeats while held, the rest act once per press
+        ButtonEvent event;
+        while (display.pollButton(event)) {
+            if (event.type != BUTTON_RELEASED) {
+                handleButton(event);
+            }
+        }
+    }
 
-        // Handle button inputs
+private:
+    void handleButton(const ButtonEvent& event) {
+        bool repeat = event.type == BUTTON_REPEATED;
 
         // Next trait
-        if (display.isButton1Pressed()) {
+        if (event.button == 0) {
             int trait = static_cast<int>(selectedTrait) + 1;
             if (trait >= NUM_TRAITS) trait = 0;
             selectedTrait = static_cast<TraitId>(trait);
             Serial.print(F("Next trait: "));
             Serial.println(TRAIT_NAMES[selectedTrait]);
-            delay(200); // Simple debounce
             updateDisplay();
         }
 
         // Previous trait
-        if (display.isButton2Pressed()) {
+        if (event.button == 1) {
             int trait = static_cast<int>(selectedTrait) - 1;
             if (trait < 0) trait = NUM_TRAITS - 1;
             selectedTrait = static_cast<TraitId>(trait);
             Serial.print(F("Previous trait: "));
             Serial.println(TRAIT_NAMES[selectedTrait]);
-            delay(200); // Simple debounce
+            updateDisplay();
+        }
+
+        // Toggle provisioning mode
+        if (event.button == 2 && !repeat && !isNFCConnected) {
+            setProvisioning(!provisioning);
             updateDisplay();
         }
 
         // Format orb
-        if (display.isButton3Pressed() && isOrbConnected) {
+        if (event.button == 2 && !repeat && isOrbConnected) {
             Serial.println(F("Format orb"));
             formatNFC(selectedTrait);
-            delay(200);
             updateDisplay();
         }
 
         // Reset orb
-        if (display.isButton4Pressed() && isNFCConnected) {
+        if (event.button == 3 && !repeat && isNFCConnected) {
             Serial.println(F("Reset orb"));
             resetOrb();
-            delay(200);
             updateDisplay();
         }
     }
 
+    void setProvisioning(bool enabled) {
+        provisioning = enabled;
+        provisionedCount = 0;
+        provisionFailures = 0;
+        lastProvisionTime = 0;
+        provisionInterval = 0;
+        setNFCCheckInterval(enabled ? PROVISION_CHECK_INTERVAL : NFC_CHECK_INTERVAL);
+        Serial.println(enabled ? F("Provisioning mode on") : F("Provisioning mode off"));
+    }
+
+    // Formats the tag on the dock and gets ready for the next one
+    void provision() {
+        if (formatNFC(selectedTrait) == STATUS_SUCCEEDED) {
+            unsigned long now = millis();
+            if (lastProvisionTime != 0) {
+                unsigned long interval = now - lastProvisionTime;
+                provisionInterval = provisionInterval == 0 ? interval : (provisionInterval * 3 + interval) / 4;
+            }
+            lastProvisionTime = now;
+            provisionedCount++;
+            setLEDPattern(LED_PATTERN_FLASH);
+            Serial.print(F("Provisioned orb "));
+            Serial.println(provisionedCount);
+        } else {
+            provisionFailures++;
+            setLEDPattern(LED_PATTERN_ERROR);
+        }
+        rearmNFCDetection();
+        updateDisplay();
+    }
+
 protected:
     void onOrbConnected() override {
+        if (provisioning) {
+            provision();
+            return;
+        }
         updateDisplay();
     }
 
@@ -128,11 +207,14 @@ protected:
 
     void onError(const char* errorMessage) override {
         display.showError(errorMessage);
-        delay(2000);
         updateDisplay();
     }
 
     void onUnformattedNFC() override {
+        if (provisioning) {
+            provision();
+            return;
+        }
         Serial.println(F("Unformatted NFC, will format with selected trait."));
         formatNFC(selectedTrait);
     }
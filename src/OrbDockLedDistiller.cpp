@@ -28,17 +28,13 @@
 #define NUM_LEDS 160
 #define LED_STRIP_PIN 7
 #define MAX_BRIGHTNESS 80
-#define MIN_BRIGHTNESS 20
+// The strip is wired from the far end
+#define DISTILLER_STRIP_DIRECTION LED_SEGMENT_REVERSED
 
 class OrbDockLedDistiller : public OrbDock {
 private:
     CRGB leds[NUM_LEDS];
-    bool showPrideEffect = true;
-    CRGB color = CRGB::Black;
-    uint16_t sLastMillis = 0;
-    bool inTransition = false;
-    uint32_t transitionStartTime = 0;
-    const uint32_t TRANSITION_DURATION = 6000; // 6 seconds
+    LedPatternEngine stripPattern;
 
 public:
     OrbDockLedDistiller() : OrbDock(StationId::DISTILLER) {
@@ -47,56 +43,42 @@ public:
 
  void begin() {
         OrbDock::begin();
-        FastLED.addLeds<WS2812B, LED_STRIP_PIN, GRB>(leds, NUM_LEDS);
-        FastLED.setBrightness(MAX_BRIGHTNESS);
-        FastLED.show();
+        ledCanvas.begin(leds);
+        CRGB* strip = ledCanvas.addSegment(NUM_LEDS, LED_OUTPUT_STRIP, DISTILLER_STRIP_DIRECTION);
+        ledEngine.addOutput(LED_OUTPUT_STRIP, FastLED.addLeds<WS2812B, LED_STRIP_PIN, GRB>(strip, NUM_LEDS), MAX_BRIGHTNESS);
+        ledEngine.show(LED_OUTPUT_STRIP);
+        stripPattern.start(LED_PATTERN_PRIDE);
         Serial.println(F("Running OrbDockLedDistiller"));
         //fill_solid(leds, NUM_LEDS, CRGB::Green);
         //FastLED.show();
     }
 
-    void loop() override {
-        OrbDock::loop();
-        if (showPrideEffect) {
-            pride2015(leds, NUM_LEDS);
-            FastLED.show();
-        }else{
-            // strobeWhiteToColorTransition(color, leds, NUM_LEDS);
-            flickerFlame(color);
-            //lightShow(color);
-            FastLED.show();
+protected:
+    uint8_t renderFrame() override {
+        uint8_t outputs = OrbDock::renderFrame();
+        // Pride while waiting for an orb, then the flame in the orb's trait color
+        LedPatternFrame frame = makeLEDFrame(ledCanvas);
+        if (stripPattern.render(frame) != LED_FRAME_UNCHANGED) {
+            outputs |= LED_OUTPUT_STRIP;
         }
+        return outputs;
     }
 
-protected:
     void onOrbConnected() override {
         Serial.println(F("OrbDockLedDistiller Connected"));
-        showPrideEffect = false;
 
         // Add energy if this station hasn't been visited yet
         if (!getCurrentStationInfo().visited) {
             addEnergy(10);
         }
 
-        // Get trait color from TRAIT_COLORS array using orbInfo.trait as index
-        uint32_t traitColor = TRAIT_COLORS[static_cast<int>(orbInfo.trait)];
-        
-        // Extract RGB components from 32-bit color
-        uint8_t r = (traitColor >> 16) & 0xFF;
-        uint8_t g = (traitColor >> 8) & 0xFF; 
-        uint8_t b = traitColor & 0xFF;
-
-        // Set color using RGB values
-        color = CRGB(r, g, b);
-
-        inTransition = true;
+        // Sparkle in to the trait color, then flicker
+        stripPattern.start(LED_PATTERN_FLAME);
     }
 
     void onOrbDisconnected() override {
         Serial.println(F("Orb disconnected"));
-        transitionStartTime = 0;
-        inTransition = false;
-        showPrideEffect = true;
+        stripPattern.start(LED_PATTERN_PRIDE);
     }
 
     void onError(const char* errorMessage) override {
@@ -133,135 +115,6 @@ protected:
         // FastLED.setBrightness(50);
     }
 
-    // Helper function for pride effect - Creates a rainbow animation with smooth transitions
-    void pride2015(CRGB* ledArray, uint16_t numLeds) {
-        // Track timing and hue state between function calls
-        static uint16_t sPseudotime = 0;
-        static uint16_t sLastMillis = 0;
-        static uint16_t sHue16 = 0;
-
-        // Generate smooth sine wave values for saturation and brightness parameters
-        uint8_t sat8 = beatsin88(87, 220, 250);  // Saturation oscillates between 220-250
-        uint8_t brightdepth = beatsin88(341, 96, 224);  // Controls depth of brightness modulation
-        uint16_t brightnessthetainc16 = beatsin88(203, (25 * 256), (40 * 256));  // Controls speed of brightness waves
-        uint8_t msmultiplier = beatsin88(147, 23, 60);  // Time scaling factor
-
-        // Set up hue parameters for color cycling
-        uint16_t hue16 = sHue16;  // Current base hue value
-        uint16_t hueinc16 = beatsin88(113, 1, 3000);  // How much to increment hue each pixel
-
-        // Calculate time delta since last update
-        uint16_t ms = millis();
-        uint16_t deltams = ms - sLastMillis;
-        sLastMillis = ms;
-        
-        // Update timing variables
-        sPseudotime += deltams * msmultiplier;  // Advance animation time
-        sHue16 += deltams * beatsin88(400, 5, 9);  // Slowly shift base hue over time
-        uint16_t brightnesstheta16 = sPseudotime;  // Starting point for brightness wave
-
-        for (uint16_t i = 0; i < numLeds; i++) {
-            // Increment hue for each LED to create rainbow pattern
-            hue16 += hueinc16;
-            uint8_t hue8 = hue16 / 256;  // Convert 16-bit hue to 8-bit
-
-            // Calculate brightness wave value for this LED
-            brightnesstheta16 += brightnessthetainc16;
-            uint16_t b16 = sin16(brightnesstheta16) + 32768;  // Generate sine wave
-
-            // Apply multiple brightness modulations
-            uint16_t bri16 = (uint32_t)((uint32_t)b16 * (uint32_t)b16) / 65536;
-            uint8_t bri8 = (uint32_t)(((uint32_t)bri16) * brightdepth) / 65536;
-            bri8 += (255 - brightdepth);
-            
-            // Map brightness to desired range
-            uint8_t new_min = MIN_BRIGHTNESS;
-            uint8_t new_max = MAX_BRIGHTNESS;
-            uint8_t old_min = 96;
-            uint8_t old_max = 224;
-            bri8 += new_min + (bri8 - old_min) * (new_max - new_min) / (old_max - old_min);
-
-            // Create new color with calculated hue, saturation and brightness
-            CRGB newcolor = CHSV(hue8, sat8, bri8);
-
-            // Reverse LED order for display
-            uint16_t pixelnumber = i;
-            pixelnumber = (numLeds - 1) - pixelnumber;
-
-            // Blend new color with existing color for smooth transitions
-            nblend(ledArray[pixelnumber], newcolor, 64);
-        }
-    }
-
-    
-    // Creates a flickering flame effect using the given base color
-    void flickerFlame(CRGB baseColor) {
-        // Track timing between updates and transition state
-        static uint16_t sLastMillis = 0;
-        
-        uint16_t ms = millis();
-        uint16_t deltams = ms - sLastMillis;
-
-        // Start transition if we haven't yet
-        if (inTransition && transitionStartTime == 0) {
-            transitionStartTime = ms;
-            fill_solid(leds, NUM_LEDS, CRGB::Black);
-        }
-
-        // Handle transition phase
-        if (inTransition) {
-            uint32_t elapsed = ms - transitionStartTime;
-            
-            if (elapsed >= TRANSITION_DURATION) {
-                // Transition complete, switch to normal flame effect
-                inTransition = false;
-                transitionStartTime = 0;
-            } else {
-                // Calculate how many sparkles based on transition progress
-                float progress = float(elapsed) / TRANSITION_DURATION;
-                int numSparkles = int(NUM_LEDS * progress * 0.5); // Max 50% of LEDs can sparkle at once
-                
-                // Clear previous frame
-                fadeToBlackBy(leds, NUM_LEDS, 200);
-                
-                // Add random white sparkles with brightness capped at MAX_BRIGHTNESS
-                for (int i = 0; i < numSparkles; i++) {
-                    int pos = random16(NUM_LEDS);
-                    if (random8() < 180) { // 70% chance of sparkle
-                        // Create white sparkle scaled to MAX_BRIGHTNESS
-                        leds[pos] = CRGB(MAX_BRIGHTNESS, MAX_BRIGHTNESS, MAX_BRIGHTNESS);
-                        // Apply random fade while maintaining relative color ratios
-                        uint8_t fade = random8(50, 150);
-                        leds[pos].fadeToBlackBy(fade);
-                    }
-                }
-                
-                // Gradually blend in base color
-                if (progress > 0.7) { // Start color blend in last 30% of transition
-                    float colorBlend = (progress - 0.7) / 0.3; // 0 to 1 over last 30%
-                    for (int i = 0; i < NUM_LEDS; i++) {
-                        leds[i] = blend(leds[i], baseColor, colorBlend * 255);
-                    }
-                }
-            }
-            FastLED.show();
-            return;
-        }
-
-        // Normal flame effect (existing code)
-        if (deltams >= 150) {
-            sLastMillis = ms;
-            
-            for (int i = 0; i < NUM_LEDS; i++) {
-                int flicker = random(MIN_BRIGHTNESS, MAX_BRIGHTNESS);
-                leds[i] = baseColor;
-                leds[i].r = (leds[i].r * flicker) / 255;
-                leds[i].g = (leds[i].g * flicker) / 255;
-                leds[i].b = (leds[i].b * flicker) / 255;
-            }
-        }
-    }
-
 /* //still in development
     void lightShow(CRGB color) {
         // currentStep controls which animation phase we're in:
@@ -27,6 +27,16 @@
 #define NUM_LEDS 16
 #define LED_STRIP_PIN 6
 
+// This station's own trait colors, by TraitId; they differ from the ring's palette centers
+static const CRGB::HTMLColorCode STRIP_TRAIT_COLORS[] = {
+    CRGB::Red,      // NONE
+    CRGB::Orange,   // RUMINATE
+    CRGB::Yellow,   // SHAME
+    CRGB::Green,    // DOUBT
+    CRGB::Pink,     // DISCONTENT
+    CRGB::Blue      // HOPELESS
+};
+
 class OrbDockLedStrip : public OrbDock {
 private:
     CRGB leds[NUM_LEDS];
@@ -34,35 +44,22 @@ private:
 
 public:
     OrbDockLedStrip() : OrbDock(StationId::GENERIC) {
-        FastLED.addLeds<WS2812B, LED_STRIP_PIN, GRB>(leds, NUM_LEDS);
-        FastLED.setBrightness(50);
-        FastLED.show();
+    }
+
+    void begin() override {
+        OrbDock::begin();
+        ledEngine.addOutput(LED_OUTPUT_STRIP, FastLED.addLeds<WS2812B, LED_STRIP_PIN, GRB>(leds, NUM_LEDS), 50);
+        ledEngine.show(LED_OUTPUT_STRIP);
     }
 
 protected:
     void onOrbConnected() override {
         
         // Set all LEDs to the trait color
-        const char* traitName = getTraitName();
-        CRGB color;
-        
-        // Match trait to color
-        if (strcmp(traitName, "RUMINATE") == 0) {
-            color = CRGB::Orange;
-        } else if (strcmp(traitName, "SHAME") == 0) {
-            color = CRGB::Yellow;
-        } else if (strcmp(traitName, "DOUBT") == 0) {
-            color = CRGB::Green;
-        } else if (strcmp(traitName, "DISCONTENT") == 0) {
-            color = CRGB::Pink;
-        } else if (strcmp(traitName, "HOPELESS") == 0) {
-            color = CRGB::Blue;
-        } else {
-            color = CRGB::Red;
-        }
-
+        uint8_t trait = orbInfo.trait;
+        CRGB color = trait < sizeof(STRIP_TRAIT_COLORS) / sizeof(STRIP_TRAIT_COLORS[0]) ? STRIP_TRAIT_COLORS[trait] : CRGB::Red;
         fill_solid(leds, NUM_LEDS, color);
-        FastLED.show();
+        requestLEDFrame(LED_OUTPUT_STRIP);
     }
 
     void onOrbDisconnected() override {
@@ -72,7 +69,7 @@ protected:
         for(int i = 0; i < NUM_LEDS; i++) {
             leds[i] = CRGB::Black;
         }
-        FastLED.show();
+        requestLEDFrame(LED_OUTPUT_STRIP);
     }
 
     void onError(const char* errorMessage) override {
@@ -0,0 +1,47 @@
+#include "PinChange.h"
+#include <avr/interrupt.h>
+
+static PinChangeHandler handlers[PIN_CHANGE_PORTS][PIN_CHANGE_HANDLERS];
+
+bool attachPinChange(uint8_t pin, PinChangeHandler handler) {
+    if (digitalPinToPCICR(pin) == 0) {
+        return false;
+    }
+    uint8_t port = digitalPinToPCICRbit(pin);
+    uint8_t slot = 0;
+    while (slot < PIN_CHANGE_HANDLERS && handlers[port][slot] != nullptr && handlers[port][slot] != handler) {
+        slot++;
+    }
+    if (slot >= PIN_CHANGE_HANDLERS) {
+        return false;
+    }
+
+    uint8_t oldSREG = SREG;
+    cli();
+    handlers[port][slot] = handler;
+    *digitalPinToPCMSK(pin) |= _BV(digitalPinToPCMSKbit(pin));
+    PCIFR = _BV(port);      // Drop any change from before the handler was attached
+    PCICR |= _BV(port);
+    SREG = oldSREG;
+    return true;
+}
+
+static inline void dispatch(uint8_t port) {
+    for (uint8_t slot = 0; slot < PIN_CHANGE_HANDLERS; slot++) {
+        if (handlers[port][slot] != nullptr) {
+            handlers[port][slot]();
+        }
+    }
+}
+
+ISR(PCINT0_vect) {
+    dispatch(0);
+}
+
+ISR(PCINT1_vect) {
+    dispatch(1);
+}
+
+ISR(PCINT2_vect) {
+    dispatch(2);
+}
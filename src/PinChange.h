@@ -0,0 +1,19 @@
+#ifndef PINCHANGE_H
+#define PINCHANGE_H
+
+#include <Arduino.h>
+
+// Shared pin change interrupts. The ATmega328 has one vector per port (PCINT0: D8-D13,
+// PCINT1: A0-A5, PCINT2: D0-D7), so modules attach a handler per pin and a port's vector calls
+// every handler on that port on any change. Handlers run in interrupt context and read their
+// own pins; they must be short.
+#define PIN_CHANGE_PORTS 3
+#define PIN_CHANGE_HANDLERS 2   // Per port
+
+typedef void (*PinChangeHandler)();
+
+// Enables the pin change interrupt for pin and calls handler on changes to its port.
+// Returns false if the pin has no pin change interrupt or its port has no free handler slot.
+bool attachPinChange(uint8_t pin, PinChangeHandler handler);
+
+#endif // PINCHANGE_H
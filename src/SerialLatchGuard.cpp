@@ -0,0 +1,110 @@
+#include "SerialLatchGuard.h"
+
+SerialLatchGuard::SerialLatchGuard() {
+    flowControl = false;
+    deferring = false;
+    xoffSent = false;
+    lineActive = false;
+    lastAvailable = 0;
+    bufferFull = false;
+    lastByte = 0;
+    deferStart = 0;
+    deferredLatches = 0;
+    forcedLatches = 0;
+    xoffs = 0;
+    rxOverflows = 0;
+    bytesAtRisk = 0;
+}
+
+void SerialLatchGuard::poll(unsigned long nowMicros) {
+    int available = Serial.available();
+    // More bytes than last time means some arrived; fewer just means they were read
+    if (available > lastAvailable) {
+        lastByte = nowMicros;
+    }
+    lastAvailable = available;
+
+    // The ring buffer keeps one slot free, so it is full one short of its size
+    bool full = available >= SERIAL_RX_BUFFER_SIZE - 1;
+    if (full && !bufferFull) {
+        rxOverflows++;
+    }
+    bufferFull = full;
+}
+
+bool SerialLatchGuard::beginLatch(unsigned long nowMicros) {
+    poll(nowMicros);
+    lineActive = nowMicros - lastByte < SERIAL_QUIET_MICROS;
+    if (!lineActive) {
+        deferring = false;
+        return true;
+    }
+
+    if (!deferring) {
+        deferring = true;
+        deferStart = nowMicros;
+        deferredLatches++;
+    }
+    if (nowMicros - deferStart < LED_LATCH_MAX_DEFER) {
+        return false;
+    }
+
+    // Waited long enough; make a quiet window if the host will pause, otherwise latch regardless
+    deferring = false;
+    if (flowControl) {
+        Serial.write(SERIAL_XOFF);
+        xoffSent = true;
+        xoffs++;
+        waitForQuiet(SERIAL_XOFF_TIMEOUT);
+        lineActive = micros() - lastByte < SERIAL_QUIET_MICROS;
+    }
+    return true;
+}
+
+void SerialLatchGuard::endLatch(unsigned long latchMicros) {
+    if (lineActive) {
+        forcedLatches++;
+        // The UART holds two bytes; everything else arriving during the latch is gone
+        unsigned long atRisk = latchMicros / SERIAL_BYTE_MICROS;
+        if (atRisk > 2) {
+            bytesAtRisk = min(bytesAtRisk + atRisk - 2, 0xFFFFUL);
+        }
+        lineActive = false;
+    }
+    if (xoffSent) {
+        Serial.write(SERIAL_XON);
+        xoffSent = false;
+    }
+}
+
+// Lets bytes already in flight land in the receive buffer (interrupts are on) before a latch
+void SerialLatchGuard::waitForQuiet(unsigned long timeout) {
+    unsigned long start = micros();
+    while (micros() - start < timeout) {
+        unsigned long now = micros();
+        poll(now);
+        if (now - lastByte >= SERIAL_QUIET_MICROS) {
+            return;
+        }
+    }
+}
+
+void SerialLatchGuard::printStats() {
+    Serial.print(F("Serial latches: "));
+    Serial.print(deferredLatches);
+    Serial.print(F(" deferred, "));
+    Serial.print(forcedLatches);
+    Serial.print(F(" forced, "));
+    Serial.print(xoffs);
+    Serial.print(F(" XOFF, "));
+    Serial.print(rxOverflows);
+    Serial.print(F(" rx overflows, ~"));
+    Serial.print(bytesAtRisk);
+    Serial.println(F(" bytes lost"));
+
+    deferredLatches = 0;
+    forcedLatches = 0;
+    xoffs = 0;
+    rxOverflows = 0;
+    bytesAtRisk = 0;
+}
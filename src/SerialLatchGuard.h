@@ -0,0 +1,65 @@
+#ifndef SERIALLATCHGUARD_H
+#define SERIALLATCHGUARD_H
+
+#include <Arduino.h>
+
+// Keeps LED latches from dropping incoming serial bytes. While a strip latches, interrupts are off
+// and the UART holds only two bytes, so anything more arriving in that time is lost. Latches wait
+// for the line to go quiet; once one has waited LED_LATCH_MAX_DEFER it goes ahead anyway, first
+// asking the host to pause with XOFF (then XON) if flow control is on.
+//
+// Flow control needs the host to honour XON/XOFF (pyserial: xonxoff=True), which also means the
+// dock must never send raw 0x11/0x13 bytes, so it is off by default: binary replies like 'S' break it.
+
+#define SERIAL_BAUD 115200
+#define SERIAL_BYTE_MICROS (10 * 1000000UL / SERIAL_BAUD)  // 87us at 115200
+#define SERIAL_QUIET_MICROS 2000        // The line counts as quiet after this long without a byte
+#define SERIAL_XOFF_TIMEOUT 10000       // us to wait for the host to stop after XOFF
+#define LED_LATCH_MAX_DEFER 100000UL    // us a latch may wait for a quiet line
+#define SERIAL_XON 0x11
+#define SERIAL_XOFF 0x13
+
+#ifndef SERIAL_RX_BUFFER_SIZE
+#define SERIAL_RX_BUFFER_SIZE 64
+#endif
+
+class SerialLatchGuard {
+public:
+    SerialLatchGuard();
+
+    void setFlowControl(bool enabled) { flowControl = enabled; }
+
+    // Notes bytes that arrived since the last call; call often, and just before reading
+    void poll(unsigned long nowMicros);
+    // Call after reading from Serial, so the next poll() counts arrivals from what is left
+    void afterRead() { lastAvailable = Serial.available(); }
+
+    // True if a latch may go ahead now. Counts the latch as deferred otherwise.
+    bool beginLatch(unsigned long nowMicros);
+    // Called after a latch that beginLatch() allowed, with how long interrupts were off for
+    void endLatch(unsigned long latchMicros);
+
+    // Prints and resets the counters
+    void printStats();
+
+private:
+    void waitForQuiet(unsigned long timeout);
+
+    bool flowControl;
+    bool deferring;
+    bool xoffSent;
+    bool lineActive;              // The current latch goes ahead while bytes are still arriving
+    int lastAvailable;
+    bool bufferFull;
+    unsigned long lastByte;       // us
+    unsigned long deferStart;     // us
+
+    // Counters since the last report
+    uint16_t deferredLatches;     // Latches that waited for a quiet line
+    uint16_t forcedLatches;       // Latches that went ahead with the line active
+    uint16_t xoffs;
+    uint16_t rxOverflows;         // Times the receive buffer filled up, dropping bytes
+    uint16_t bytesAtRisk;         // Estimated bytes lost to forced latches
+};
+
+#endif // SERIALLATCHGUARD_H
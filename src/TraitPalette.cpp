@@ -0,0 +1,28 @@
+#include "TraitPalette.h"
+
+// Generated offline: entry k is the trait color with its HSV hue rotated by (k - 8) * 6 degrees,
+// so entry 8 (TRAIT_PALETTE_CENTER) is the trait color exactly
+const TProgmemRGBPalette16 TRAIT_PALETTES[TRAIT_PALETTE_COUNT] PROGMEM = {
+    // NONE, red 0xFF0000
+    { 0xFF00CC, 0xFF00B3, 0xFF0099, 0xFF0080, 0xFF0066, 0xFF004D, 0xFF0033, 0xFF001A,
+      0xFF0000, 0xFF1900, 0xFF3300, 0xFF4D00, 0xFF6600, 0xFF8000, 0xFF9900, 0xFFB200 },
+    // RUMINATE, orange 0xFF2800
+    { 0xFF00A4, 0xFF008A, 0xFF0071, 0xFF0058, 0xFF003E, 0xFF0025, 0xFF000B, 0xFF0F00,
+      0xFF2800, 0xFF4200, 0xFF5B00, 0xFF7500, 0xFF8E00, 0xFFA800, 0xFFC100, 0xFFDA00 },
+    // SHAME, yellow 0xFF6000
+    { 0xFF006C, 0xFF0053, 0xFF0039, 0xFF0020, 0xFF0006, 0xFF1300, 0xFF2D00, 0xFF4600,
+      0xFF6000, 0xFF7A00, 0xFF9300, 0xFFAC00, 0xFFC600, 0xFFDF00, 0xFFF900, 0xECFF00 },
+    // DOUBT, green 0x20FF00
+    { 0xECFF00, 0xD2FF00, 0xB9FF00, 0xA0FF00, 0x86FF00, 0x6CFF00, 0x53FF00, 0x3AFF00,
+      0x20FF00, 0x06FF00, 0x00FF13, 0x00FF2C, 0x00FF46, 0x00FF60, 0x00FF79, 0x00FF93 },
+    // DISCONTENT, pink 0xFF00D2
+    { 0x6000FF, 0x7A00FF, 0x9300FF, 0xAD00FF, 0xC600FF, 0xE000FF, 0xF900FF, 0xFF00EC,
+      0xFF00D2, 0xFF00B8, 0xFF009F, 0xFF0085, 0xFF006C, 0xFF0052, 0xFF0039, 0xFF001F },
+    // HOPELESS, blue 0x1400FF
+    { 0x00B8FF, 0x009FFF, 0x0085FF, 0x006CFF, 0x0052FF, 0x0039FF, 0x001FFF, 0x0006FF,
+      0x1400FF, 0x2D00FF, 0x4700FF, 0x6000FF, 0x7A00FF, 0x9300FF, 0xAD00FF, 0xC600FF }
+};
+
+void loadTraitPalette(CRGBPalette16& palette, uint8_t trait) {
+    palette = TRAIT_PALETTES[trait < TRAIT_PALETTE_COUNT ? trait : 0];
+}
@@ -0,0 +1,22 @@
+#ifndef TRAIT_PALETTE_H
+#define TRAIT_PALETTE_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+// Per-trait color palettes. Each trait's 16 entries step its color through the neighbouring hues,
+// 6 degrees apart, so renderers shift hue by moving the palette index instead of doing color math.
+// A dock loads the palette into RAM once when the orb's trait changes (see OrbDock::makeLEDFrame).
+
+#define TRAIT_PALETTE_COUNT 6          // One per TraitId
+#define TRAIT_PALETTE_CENTER 128       // Index of the trait color itself
+// Palette index offset for a hue shift in degrees, from -48 to +42 (16 index steps per 6 degrees)
+#define TRAIT_PALETTE_SHIFT(degrees) ((degrees) * 8 / 3)
+
+// Indexed by TraitId, in flash
+extern const TProgmemRGBPalette16 TRAIT_PALETTES[TRAIT_PALETTE_COUNT] PROGMEM;
+
+// Loads a trait's palette; unknown traits get the NONE palette
+void loadTraitPalette(CRGBPalette16& palette, uint8_t trait);
+
+#endif
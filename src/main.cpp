@@ -15,7 +15,7 @@ OrbDockComms orbDock(10, 11, 9, 13);
 //OrbDockLedDistiller orbDock{};
 
 void setup() {
-    Serial.begin(115200);
+    Serial.begin(SERIAL_BAUD);
     while (!Serial) delay(10);
     orbDock.begin();
 }
@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""
+Host-side tool for orb tag images (see ORB_IMAGE_* in src/OrbDock.h).
+
+  orb_image.py snapshot PORT ARCHIVE        Snapshot the orb on the dock and append it to ARCHIVE
+  orb_image.py restore PORT ARCHIVE [-n N]  Restore the latest (or Nth) archived image of the orb on the dock
+  orb_image.py validate ARCHIVE...          Check every image in one or more archives
+  orb_image.py list ARCHIVE                 List archived images
+
+An archive is an append-only file: the 4-byte header "ORBA", then one record per image,
+each a little-endian uint32 unix timestamp followed by the image exactly as the dock sent it.
+
+Needs pyserial for the commands that talk to a dock (it ships with PlatformIO).
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+IMAGE_MAGIC = b"ORBI"
+IMAGE_VERSION = 1
+HEADER_SIZE = 15
+ARCHIVE_MAGIC = b"ORBA"
+BAUD_RATE = 115200
+STATION_NAMES = ["GENERIC", "CONFIGURE", "CONSOLE", "DISTILLER", "CASINO", "FOREST",
+                 "ALCHEMY", "PIPES", "CHECKER", "SLERP", "RETOXIFY",
+                 "GENERATOR", "STRING", "CHILL", "HUNT"]
+TRAIT_NAMES = ["NONE", "RUMINATE", "SHAME", "DOUBT", "DISCONTENT", "HOPELESS"]
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, matching src/Crc16.h."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def image_size(header):
+    return HEADER_SIZE + header[14] * 4 + 2
+
+
+def check_image(image):
+    """Returns None if the image is valid, otherwise a reason."""
+    if len(image) < HEADER_SIZE or image[:4] != IMAGE_MAGIC:
+        return "bad magic"
+    if image[4] != IMAGE_VERSION:
+        return "unsupported version %d" % image[4]
+    if len(image) != image_size(image):
+        return "truncated"
+    if crc16(image[:-2]) != struct.unpack(">H", image[-2:])[0]:
+        return "bad CRC"
+    return None
+
+
+def describe(image):
+    uid = image[6:6 + image[5]].hex(":")
+    page = lambda n: image[HEADER_SIZE + n * 4:HEADER_SIZE + n * 4 + 4]
+    if page(4) != b"ORBS":
+        return "%s unformatted" % uid
+    trait = page(5)[0]
+    trait = TRAIT_NAMES[trait] if trait < len(TRAIT_NAMES) else "?%d" % trait
+    visited = [name for i, name in enumerate(STATION_NAMES[:14]) if page(7 + i)[0] == 1]
+    return "%s %s energy=%d visited=%s" % (uid, trait, page(6)[0], ",".join(visited) or "-")
+
+
+def read_archive(path):
+    """Yields (offset, timestamp, image) for each record. Stops at a truncated tail."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != ARCHIVE_MAGIC:
+        raise ValueError("%s: not an orb archive" % path)
+    offset = 4
+    while offset + 4 + HEADER_SIZE <= len(data):
+        timestamp, = struct.unpack_from("<I", data, offset)
+        header = data[offset + 4:offset + 4 + HEADER_SIZE]
+        end = offset + 4 + image_size(header)
+        yield offset, timestamp, data[offset + 4:end]
+        offset = end
+    if offset != len(data):
+        yield offset, None, data[offset:]
+
+
+def append_archive(path, image):
+    with open(path, "ab+") as f:
+        f.seek(0, 2)
+        if f.tell() == 0:
+            f.write(ARCHIVE_MAGIC)
+        f.write(struct.pack("<I", int(time.time())) + image)
+
+
+def open_dock(port):
+    import serial
+    dock = serial.Serial(port, BAUD_RATE, timeout=3)
+    time.sleep(2)  # Opening the port resets the Nano
+    dock.reset_input_buffer()
+    return dock
+
+
+def request_snapshot(dock):
+    """Sends the snapshot command and returns the image, skipping any log text before it."""
+    dock.write(b"S")
+    window = b""
+    line = b""
+    while True:
+        byte = dock.read(1)
+        if not byte:
+            raise IOError("no image received")
+        window = (window + byte)[-len(IMAGE_MAGIC):]
+        if window == IMAGE_MAGIC:
+            break
+        line = b"" if byte == b"\n" else line + byte
+        if line.startswith(b"SNAPSHOT FAILED") and byte == b"\r":
+            raise IOError(line.decode("ascii", "replace"))
+    header = IMAGE_MAGIC + dock.read(HEADER_SIZE - len(IMAGE_MAGIC))
+    image = header + dock.read(image_size(header) - HEADER_SIZE)
+    error = check_image(image)
+    if error:
+        raise IOError("received image is invalid: %s" % error)
+    return image
+
+
+def cmd_snapshot(args):
+    dock = open_dock(args.port)
+    image = request_snapshot(dock)
+    append_archive(args.archive, image)
+    print("archived", describe(image))
+
+
+def cmd_restore(args):
+    dock = open_dock(args.port)
+    uid = request_snapshot(dock)[6:6 + 7]
+    images = [image for _, _, image in read_archive(args.archive)
+              if check_image(image) is None and image[6:6 + 7] == uid]
+    if not images:
+        sys.exit("no valid archived image for %s" % uid.hex(":"))
+    image = images[args.n] if args.n is not None else images[-1]
+    print("restoring", describe(image))
+    dock.write(b"R" + image)
+    while True:
+        line = dock.readline()
+        if not line:
+            sys.exit("no reply from dock")
+        line = line.decode("ascii", "replace").strip()
+        if line.startswith("RESTORE"):
+            print(line)
+            sys.exit(0 if line.startswith("RESTORE OK") else 1)
+
+
+def cmd_validate(args):
+    bad = 0
+    total = 0
+    for path in args.archives:
+        for offset, _, image in read_archive(path):
+            total += 1
+            error = check_image(image)
+            if error:
+                bad += 1
+                print("%s@%d: %s" % (path, offset, error))
+    print("%d images, %d invalid" % (total, bad))
+    sys.exit(1 if bad else 0)
+
+
+def cmd_list(args):
+    for index, (offset, timestamp, image) in enumerate(read_archive(args.archive)):
+        when = time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(timestamp)) if timestamp else "-"
+        error = check_image(image)
+        print("%4d %s %s" % (index, when, error or describe(image)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+    p = commands.add_parser("snapshot")
+    p.add_argument("port")
+    p.add_argument("archive")
+    p.set_defaults(func=cmd_snapshot)
+    p = commands.add_parser("restore")
+    p.add_argument("port")
+    p.add_argument("archive")
+    p.add_argument("-n", type=int, help="index among this orb's images (default: latest)")
+    p.set_defaults(func=cmd_restore)
+    p = commands.add_parser("validate")
+    p.add_argument("archives", nargs="+")
+    p.set_defaults(func=cmd_validate)
+    p = commands.add_parser("list")
+    p.add_argument("archive")
+    p.set_defaults(func=cmd_list)
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()